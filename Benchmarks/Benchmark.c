@@ -0,0 +1,696 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+#include "Animation.h"
+#include "Assets.h"
+#include "Context.h"
+#include "Geometry.h"
+#include "Glyphs.h"
+#include "Level.h"
+#include "Profiler.h"
+#include "Text.h"
+#include "Utilities.h"
+
+#define BENCHMARK_CONTEXT_WIDTH  1280
+#define BENCHMARK_CONTEXT_HEIGHT  720
+
+#define BENCHMARK_LIMIT            256ULL
+#define BENCHMARK_NAME_SIZE         64ULL
+#define DEFAULT_BENCHMARK_DURATION 200.0
+#define DEFAULT_REGRESSION_PERCENT  10.0
+
+// Delta time that finishes any animation a move or an undo started, so that the level takes the next input right away
+#define SETTLE_DELTA_TIME 100000.0
+
+// Set from the command line:
+//   --filter <TEXT>       Only run the benchmarks whose name contains the text
+//   --time <MS>           Time spent measuring each benchmark, after a warm-up run
+//   --baseline <PATH>     Compare against a baseline file and exit with a failure when a benchmark regressed
+//   --save <PATH>         Save the results as a baseline file
+//   --threshold <PERCENT> Slowdown over the baseline that counts as a regression
+static const char *benchmark_filter = NULL;
+static double benchmark_duration = DEFAULT_BENCHMARK_DURATION;
+static const char *baseline_path = NULL;
+static const char *save_path = NULL;
+static double regression_percent = DEFAULT_REGRESSION_PERCENT;
+
+struct BenchmarkResult {
+        char name[BENCHMARK_NAME_SIZE];
+        double nanoseconds_per_operation;
+        double allocations_per_operation;
+        size_t vertex_count;
+};
+
+static struct BenchmarkResult results[BENCHMARK_LIMIT];
+static size_t result_count = 0ULL;
+
+static struct BenchmarkResult baselines[BENCHMARK_LIMIT];
+static size_t baseline_count = 0ULL;
+
+static void parse_arguments(const int argument_count, char *const argument_values[]);
+static void initialize(void);
+static void terminate(const int exit_code);
+
+static void benchmark_geometry(void);
+static void benchmark_text(void);
+static void benchmark_animation(void);
+static void benchmark_levels(void);
+
+static bool load_baselines(const char *const path);
+static bool save_baselines(const char *const path);
+static bool report_results(void);
+
+int main(const int argument_count, char *const argument_values[]) {
+        parse_arguments(argument_count, argument_values);
+        initialize();
+
+#ifndef NDEBUG
+        send_message(MESSAGE_WARNING, "Benchmarking a debug build, the timings include allocation tracking and profiling");
+#endif
+
+        if (baseline_path && !load_baselines(baseline_path)) {
+                terminate(EXIT_FAILURE);
+        }
+
+        benchmark_geometry();
+        benchmark_text();
+        benchmark_animation();
+        benchmark_levels();
+
+        const bool passed = report_results();
+        if (save_path && !save_baselines(save_path)) {
+                terminate(EXIT_FAILURE);
+        }
+
+        terminate(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+        return EXIT_FAILURE;
+}
+
+static void parse_arguments(const int argument_count, char *const argument_values[]) {
+        for (int argument_index = 1; argument_index < argument_count; ++argument_index) {
+                const char *const argument = argument_values[argument_index];
+                const bool has_value = argument_index + 1 < argument_count;
+
+                if (!strcmp(argument, "--filter") && has_value) {
+                        benchmark_filter = argument_values[++argument_index];
+                } else if (!strcmp(argument, "--time") && has_value) {
+                        const double duration = strtod(argument_values[++argument_index], NULL);
+                        if (duration <= 0.0) {
+                                send_message(MESSAGE_WARNING, "Invalid time \"%s\", using %.0lf", argument_values[argument_index], DEFAULT_BENCHMARK_DURATION);
+                        } else {
+                                benchmark_duration = duration;
+                        }
+                } else if (!strcmp(argument, "--baseline") && has_value) {
+                        baseline_path = argument_values[++argument_index];
+                } else if (!strcmp(argument, "--save") && has_value) {
+                        save_path = argument_values[++argument_index];
+                } else if (!strcmp(argument, "--threshold") && has_value) {
+                        const double percent = strtod(argument_values[++argument_index], NULL);
+                        if (percent <= 0.0) {
+                                send_message(MESSAGE_WARNING, "Invalid threshold \"%s\", using %.0lf", argument_values[argument_index], DEFAULT_REGRESSION_PERCENT);
+                        } else {
+                                regression_percent = percent;
+                        }
+                } else {
+                        send_message(MESSAGE_WARNING, "Ignoring unknown argument \"%s\"", argument);
+                }
+        }
+}
+
+static void initialize(void) {
+        if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) < 0 || TTF_Init() < 0) {
+                send_message(MESSAGE_FATAL, "Failed to initialize benchmarks: Failed to initialize SDL: %s", SDL_GetMESSAGE_ERROR());
+                terminate(EXIT_FAILURE);
+        }
+
+        // The job system is left off, so tessellation runs inline on this thread and the allocation counts stay exact
+        if (!initialize_headless_context(BENCHMARK_CONTEXT_WIDTH, BENCHMARK_CONTEXT_HEIGHT)) {
+                send_message(MESSAGE_FATAL, "Failed to initialize benchmarks: Failed to initialize context");
+                terminate(EXIT_FAILURE);
+        }
+
+        if (!load_assets("Assets/Assets.json")) {
+                send_message(MESSAGE_FATAL, "Failed to initialize benchmarks: Failed to load assets");
+                terminate(EXIT_FAILURE);
+        }
+}
+
+static void terminate(const int exit_code) {
+        terminate_animation_system();
+        terminate_geometry_batch();
+        terminate_geometry_arena();
+        terminate_glyph_atlases();
+
+        unload_assets();
+        terminate_context();
+        terminate_profiler();
+
+        TTF_Quit();
+        SDL_Quit();
+
+        flush_memory_leaks();
+        exit(exit_code);
+}
+
+// ================================================================================================
+// Measurement
+// ================================================================================================
+
+static bool is_benchmark_selected(const char *const name) {
+        return !benchmark_filter || strstr(name, benchmark_filter);
+}
+
+// Runs the operation in batches that double in size until a batch lasts the requested time, which keeps the timer's overhead
+// and resolution out of the result, and reports the operation's average over that last batch
+static struct BenchmarkResult *measure_benchmark(const char *const name, void (*const operation)(void *), void *const data) {
+        if (result_count == BENCHMARK_LIMIT) {
+                send_message(MESSAGE_WARNING, "Failed to run benchmark \"%s\": More than %zu benchmarks were run", name, BENCHMARK_LIMIT);
+                return NULL;
+        }
+
+        // The first run warms up the caches and grows every buffer the operation reuses
+        operation(data);
+
+        const double ticks_per_nanosecond = (double)SDL_GetPerformanceFrequency() / 1000000000.0;
+        const double minimum_ticks = benchmark_duration * 1000000.0 * ticks_per_nanosecond;
+
+        size_t iteration_count = 1ULL;
+        while (true) {
+                const size_t first_allocation = get_memory_allocation_count();
+                const Uint64 start = SDL_GetPerformanceCounter();
+
+                for (size_t iteration = 0ULL; iteration < iteration_count; ++iteration) {
+                        operation(data);
+                }
+
+                const Uint64 finish = SDL_GetPerformanceCounter();
+                const size_t allocation_count = get_memory_allocation_count() - first_allocation;
+
+                if ((double)(finish - start) >= minimum_ticks || iteration_count >= SIZE_MAX / 2ULL) {
+                        struct BenchmarkResult *const result = &results[result_count++];
+                        snprintf(result->name, sizeof(result->name), "%s", name);
+                        result->nanoseconds_per_operation = (double)(finish - start) / ticks_per_nanosecond / (double)iteration_count;
+                        result->allocations_per_operation = (double)allocation_count / (double)iteration_count;
+                        result->vertex_count = 0ULL;
+                        return result;
+                }
+
+                iteration_count *= 2ULL;
+        }
+}
+
+// ================================================================================================
+// Geometry
+// ================================================================================================
+
+enum GeometryShape {
+        SHAPE_TRIANGLE,
+        SHAPE_LINE,
+        SHAPE_RECTANGLE,
+        SHAPE_QUADRILATERAL,
+        SHAPE_CIRCLE,
+        SHAPE_ELLIPSE,
+        SHAPE_CIRCULAR_ARC,
+        SHAPE_ELLIPTICAL_ARC,
+        SHAPE_CIRCLE_OUTLINE,
+        SHAPE_ELLIPSE_OUTLINE,
+        SHAPE_CIRCULAR_ARC_OUTLINE,
+        SHAPE_ELLIPTICAL_ARC_OUTLINE,
+        SHAPE_HEXAGON,
+        SHAPE_BEZIER_CURVE,
+        SHAPE_ROUNDED_TRIANGLE,
+        SHAPE_ROUNDED_RECTANGLE,
+        SHAPE_ROUNDED_QUADRILATERAL,
+        SHAPE_ROTATED,
+        SHAPE_COUNT
+};
+
+static const char *const shape_names[SHAPE_COUNT] = {
+        "write_triangle_geometry",
+        "write_line_geometry",
+        "write_rectangle_geometry",
+        "write_quadrilateral_geometry",
+        "write_circle_geometry",
+        "write_ellipse_geometry",
+        "write_circular_arc_geometry",
+        "write_elliptical_arc_geometry",
+        "write_circle_outline_geometry",
+        "write_ellipse_outline_geometry",
+        "write_circular_arc_outline_geometry",
+        "write_elliptical_arc_outline_geometry",
+        "write_hexagon_geometry",
+        "write_bezier_curve_geometry",
+        "write_rounded_triangle_geometry",
+        "write_rounded_rectangle_geometry",
+        "write_rounded_quadrilateral_geometry",
+        "write_rotated_geometry"
+};
+
+// Curves are tessellated by their size on screen, so every shape is measured from a small icon up to a full screen
+static const float shape_sizes[] = { 8.0f, 64.0f, 512.0f };
+
+struct GeometryBenchmark {
+        struct Geometry *geometry;
+        struct Geometry *source;
+        enum GeometryShape shape;
+        float size;
+};
+
+static void run_geometry_benchmark(void *const data) {
+        struct GeometryBenchmark *const benchmark = (struct GeometryBenchmark *)data;
+        struct Geometry *const geometry = benchmark->geometry;
+        const float s = benchmark->size;
+        const float x = (float)BENCHMARK_CONTEXT_WIDTH / 2.0f;
+        const float y = (float)BENCHMARK_CONTEXT_HEIGHT / 2.0f;
+        const float line_width = MAXIMUM_VALUE(s / 16.0f, 1.0f);
+
+        clear_geometry(geometry);
+        switch (benchmark->shape) {
+                case SHAPE_TRIANGLE: {
+                        write_triangle_geometry(geometry, x, y - s, x + s, y + s, x - s, y + s);
+                        break;
+                }
+
+                case SHAPE_LINE: {
+                        write_line_geometry(geometry, x - s, y - s, x + s, y + s, line_width, LINE_CAP_BOTH);
+                        break;
+                }
+
+                case SHAPE_RECTANGLE: {
+                        write_rectangle_geometry(geometry, x - s, y - s / 2.0f, s * 2.0f, s, 0.3f);
+                        break;
+                }
+
+                case SHAPE_QUADRILATERAL: {
+                        write_quadrilateral_geometry(geometry, x - s, y - s, x + s, y - s / 2.0f, x + s, y + s, x - s / 2.0f, y + s);
+                        break;
+                }
+
+                case SHAPE_CIRCLE: {
+                        write_circle_geometry(geometry, x, y, s);
+                        break;
+                }
+
+                case SHAPE_ELLIPSE: {
+                        write_ellipse_geometry(geometry, x, y, s, s / 2.0f, 0.3f);
+                        break;
+                }
+
+                case SHAPE_CIRCULAR_ARC: {
+                        write_circular_arc_geometry(geometry, x, y, s, 0.0f, (float)M_PI * 1.5f, false);
+                        break;
+                }
+
+                case SHAPE_ELLIPTICAL_ARC: {
+                        write_elliptical_arc_geometry(geometry, x, y, s, s / 2.0f, 0.3f, 0.0f, (float)M_PI * 1.5f, false);
+                        break;
+                }
+
+                case SHAPE_CIRCLE_OUTLINE: {
+                        write_circle_outline_geometry(geometry, x, y, s, line_width);
+                        break;
+                }
+
+                case SHAPE_ELLIPSE_OUTLINE: {
+                        write_ellipse_outline_geometry(geometry, x, y, s, s / 2.0f, line_width);
+                        break;
+                }
+
+                case SHAPE_CIRCULAR_ARC_OUTLINE: {
+                        write_circular_arc_outline_geometry(geometry, x, y, s, line_width, 0.0f, (float)M_PI * 1.5f, false, LINE_CAP_BOTH);
+                        break;
+                }
+
+                case SHAPE_ELLIPTICAL_ARC_OUTLINE: {
+                        write_elliptical_arc_outline_geometry(geometry, x, y, s, s / 2.0f, 0.3f, line_width, 0.0f, (float)M_PI * 1.5f, false, LINE_CAP_BOTH);
+                        break;
+                }
+
+                case SHAPE_HEXAGON: {
+                        write_hexagon_geometry(geometry, x, y, s, 0.0f);
+                        break;
+                }
+
+                case SHAPE_BEZIER_CURVE: {
+                        write_bezier_curve_geometry(geometry, x - s, y, x + s, y, x - s / 2.0f, y - s, x + s / 2.0f, y + s, line_width);
+                        break;
+                }
+
+                case SHAPE_ROUNDED_TRIANGLE: {
+                        write_rounded_triangle_geometry(geometry, x, y - s, x + s, y + s, x - s, y + s, s / 4.0f);
+                        break;
+                }
+
+                case SHAPE_ROUNDED_RECTANGLE: {
+                        write_rounded_rectangle_geometry(geometry, x - s, y - s / 2.0f, s * 2.0f, s, s / 4.0f, 0.3f);
+                        break;
+                }
+
+                case SHAPE_ROUNDED_QUADRILATERAL: {
+                        write_rounded_quadrilateral_geometry(geometry, x - s, y - s, x + s, y - s / 2.0f, x + s, y + s, x - s / 2.0f, y + s, s / 4.0f);
+                        break;
+                }
+
+                case SHAPE_ROTATED: {
+                        write_rotated_geometry(geometry, benchmark->source, x, y, 0.3f);
+                        break;
+                }
+
+                default: {
+                        break;
+                }
+        }
+}
+
+static void benchmark_geometry(void) {
+        for (size_t shape = 0ULL; shape < SHAPE_COUNT; ++shape) {
+                for (size_t size_index = 0ULL; size_index < sizeof(shape_sizes) / sizeof(shape_sizes[0]); ++size_index) {
+                        char name[BENCHMARK_NAME_SIZE];
+                        snprintf(name, sizeof(name), "%s/%.0f", shape_names[shape], (double)shape_sizes[size_index]);
+                        if (!is_benchmark_selected(name)) {
+                                continue;
+                        }
+
+                        struct GeometryBenchmark benchmark = {
+                                .geometry = create_geometry(),
+                                .source = create_geometry(),
+                                .shape = (enum GeometryShape)shape,
+                                .size = shape_sizes[size_index]
+                        };
+
+                        // Rotation copies an existing geometry, a rounded rectangle stands in for a button
+                        const float x = (float)BENCHMARK_CONTEXT_WIDTH / 2.0f;
+                        const float y = (float)BENCHMARK_CONTEXT_HEIGHT / 2.0f;
+                        write_rounded_rectangle_geometry(benchmark.source, x - benchmark.size, y - benchmark.size / 2.0f, benchmark.size * 2.0f, benchmark.size, benchmark.size / 4.0f, 0.0f);
+
+                        struct BenchmarkResult *const result = measure_benchmark(name, run_geometry_benchmark, &benchmark);
+                        if (result) {
+                                get_geometry_peak_data(benchmark.geometry, &result->vertex_count, NULL);
+                        }
+
+                        destroy_geometry(benchmark.source);
+                        destroy_geometry(benchmark.geometry);
+                }
+        }
+}
+
+// ================================================================================================
+// Text
+// ================================================================================================
+
+#define TEXT_SAMPLE "The quick brown fox jumps over the lazy dog, then pushes 12 blocks onto their spots. "
+
+static const size_t text_lengths[] = { 8ULL, 64ULL, 512ULL };
+
+struct TextBenchmark {
+        struct Text text;
+        char *strings[2];
+        size_t string_index;
+};
+
+// Every operation swaps between two strings of the same length, so that the layout is redone each time
+static void run_text_benchmark(void *const data) {
+        struct TextBenchmark *const benchmark = (struct TextBenchmark *)data;
+        benchmark->string_index ^= 1ULL;
+
+        set_text_string(&benchmark->text, benchmark->strings[benchmark->string_index]);
+        get_text_dimensions(&benchmark->text, NULL, NULL);
+}
+
+static char *create_sample_string(const size_t length, const size_t offset) {
+        const size_t sample_length = sizeof(TEXT_SAMPLE) - 1ULL;
+
+        char *const string = (char *)xmalloc(length + 1ULL);
+        for (size_t character_index = 0ULL; character_index < length; ++character_index) {
+                string[character_index] = TEXT_SAMPLE[(character_index + offset) % sample_length];
+        }
+
+        string[length] = '\0';
+        return string;
+}
+
+static void benchmark_text(void) {
+        for (size_t length_index = 0ULL; length_index < sizeof(text_lengths) / sizeof(text_lengths[0]); ++length_index) {
+                char name[BENCHMARK_NAME_SIZE];
+                snprintf(name, sizeof(name), "refresh_text/%zu", text_lengths[length_index]);
+                if (!is_benchmark_selected(name)) {
+                        continue;
+                }
+
+                struct TextBenchmark benchmark = {
+                        .strings = {
+                                create_sample_string(text_lengths[length_index], 0ULL),
+                                create_sample_string(text_lengths[length_index], 1ULL)
+                        },
+                        .string_index = 0ULL
+                };
+
+                // The first layout rasterizes every glyph of the sample right away, the measured ones only find them in the atlas
+                initialize_text(&benchmark.text, TEXT_SAMPLE, FONT_BODY);
+                set_text_maximum_width(&benchmark.text, (float)BENCHMARK_CONTEXT_WIDTH / 2.0f);
+                get_text_dimensions(&benchmark.text, NULL, NULL);
+
+                measure_benchmark(name, run_text_benchmark, &benchmark);
+
+                deinitialize_text(&benchmark.text);
+                xfree(benchmark.strings[0]);
+                xfree(benchmark.strings[1]);
+        }
+}
+
+// ================================================================================================
+// Animation
+// ================================================================================================
+
+static const size_t animation_counts[] = { 16ULL, 256ULL, 4096ULL };
+
+// Long enough that no animation finishes while it is measured
+#define BENCHMARK_ANIMATION_DURATION 1.0e9f
+
+static void run_animation_benchmark(void *const data) {
+        (void)data;
+        update_animation_system(1000.0 / 60.0, 1000.0 / 60.0);
+}
+
+static void benchmark_animation(void) {
+        for (size_t count_index = 0ULL; count_index < sizeof(animation_counts) / sizeof(animation_counts[0]); ++count_index) {
+                const size_t animation_count = animation_counts[count_index];
+
+                char name[BENCHMARK_NAME_SIZE];
+                snprintf(name, sizeof(name), "update_animation_system/%zu", animation_count);
+                if (!is_benchmark_selected(name)) {
+                        continue;
+                }
+
+                struct Animation *const animations = (struct Animation *)xmalloc(animation_count * sizeof(struct Animation));
+                float *const values = (float *)xcalloc(animation_count, sizeof(float));
+
+                // Easings are spread over the animations the way a scene mixes them
+                for (size_t animation_index = 0ULL; animation_index < animation_count; ++animation_index) {
+                        struct Animation *const animation = &animations[animation_index];
+                        initialize_animation(animation, 1ULL);
+
+                        animation->actions[0].type = ACTION_FLOAT;
+                        animation->actions[0].easing = (enum Easing)(animation_index % EASING_COUNT);
+                        animation->actions[0].duration = BENCHMARK_ANIMATION_DURATION;
+                        animation->actions[0].target.float_pointer = &values[animation_index];
+                        animation->actions[0].keyframes.floats[0] = 0.0f;
+                        animation->actions[0].keyframes.floats[1] = 1.0f;
+
+                        start_animation(animation, 0ULL);
+                }
+
+                measure_benchmark(name, run_animation_benchmark, NULL);
+
+                for (size_t animation_index = 0ULL; animation_index < animation_count; ++animation_index) {
+                        deinitialize_animation(&animations[animation_index]);
+                }
+
+                xfree(values);
+                xfree(animations);
+        }
+}
+
+// ================================================================================================
+// Levels
+// ================================================================================================
+
+struct LevelBenchmark {
+        struct Level level;
+        const struct LevelMetadata *metadata;
+};
+
+static void ignore_level_completion(void *const data) {
+        (void)data;
+}
+
+static void press_level_key(struct Level *const level, const SDL_Keycode key) {
+        SDL_Event event;
+        memset(&event, 0, sizeof(event));
+        event.type = SDL_KEYDOWN;
+        event.key.keysym.sym = key;
+
+        level_receive_event(level, &event);
+        update_animation_system(SETTLE_DELTA_TIME, SETTLE_DELTA_TIME);
+}
+
+// A turn and a step forward, then both undone, which leaves the level as it was whether or not the step was blocked
+static void run_level_move_benchmark(void *const data) {
+        struct Level *const level = &((struct LevelBenchmark *)data)->level;
+        press_level_key(level, SDLK_RIGHT);
+        press_level_key(level, SDLK_UP);
+        press_level_key(level, SDLK_z);
+        press_level_key(level, SDLK_z);
+}
+
+// Parsing isn't reachable on its own, so a load is measured whole, from reading the file to laying out the grid
+static void run_level_load_benchmark(void *const data) {
+        struct LevelBenchmark *const benchmark = (struct LevelBenchmark *)data;
+        if (initialize_level(&benchmark->level, benchmark->metadata)) {
+                deinitialize_level(&benchmark->level);
+        }
+}
+
+static void benchmark_levels(void) {
+        for (size_t level_index = 0ULL; level_index < get_level_count(); ++level_index) {
+                const size_t level_number = level_index + 1ULL;
+                struct LevelBenchmark benchmark = {
+                        .metadata = get_level_metadata(level_index)
+                };
+
+                char name[BENCHMARK_NAME_SIZE];
+                snprintf(name, sizeof(name), "parse_level/%zu", level_number);
+                if (is_benchmark_selected(name)) {
+                        measure_benchmark(name, run_level_load_benchmark, &benchmark);
+                }
+
+                snprintf(name, sizeof(name), "level_move_step/%zu", level_number);
+                if (!is_benchmark_selected(name)) {
+                        continue;
+                }
+
+                if (!initialize_level(&benchmark.level, benchmark.metadata)) {
+                        send_message(MESSAGE_ERROR, "Failed to run benchmark \"%s\": Failed to initialize level", name);
+                        continue;
+                }
+
+                benchmark.level.completion_callback = ignore_level_completion;
+                measure_benchmark(name, run_level_move_benchmark, &benchmark);
+                deinitialize_level(&benchmark.level);
+        }
+}
+
+// ================================================================================================
+// Baselines
+// ================================================================================================
+
+static const struct BenchmarkResult *find_baseline(const char *const name) {
+        for (size_t baseline_index = 0ULL; baseline_index < baseline_count; ++baseline_index) {
+                if (!strcmp(baselines[baseline_index].name, name)) {
+                        return &baselines[baseline_index];
+                }
+        }
+
+        return NULL;
+}
+
+// Baseline files hold a benchmark per line: its name, nanoseconds and allocations per operation, and vertices emitted
+static bool load_baselines(const char *const path) {
+        FILE *const file = fopen(path, "r");
+        if (!file) {
+                send_message(MESSAGE_ERROR, "Failed to load baselines: Failed to open \"%s\": %s", path, strerror(errno));
+                return false;
+        }
+
+        char line[256];
+        while (fgets(line, sizeof(line), file) && baseline_count < BENCHMARK_LIMIT) {
+                if (line[0] == '#' || line[0] == '\n') {
+                        continue;
+                }
+
+                struct BenchmarkResult *const baseline = &baselines[baseline_count];
+                if (sscanf(line, "%63s %lf %lf %zu", baseline->name, &baseline->nanoseconds_per_operation, &baseline->allocations_per_operation, &baseline->vertex_count) != 4) {
+                        send_message(MESSAGE_WARNING, "Ignoring invalid baseline line \"%s\" in \"%s\"", line, path);
+                        continue;
+                }
+
+                ++baseline_count;
+        }
+
+        fclose(file);
+        return true;
+}
+
+static bool save_baselines(const char *const path) {
+        FILE *const file = fopen(path, "w");
+        if (!file) {
+                send_message(MESSAGE_ERROR, "Failed to save baselines: Failed to open \"%s\": %s", path, strerror(errno));
+                return false;
+        }
+
+        fprintf(file, "# name ns/op allocations/op vertices\n");
+        for (size_t result_index = 0ULL; result_index < result_count; ++result_index) {
+                const struct BenchmarkResult *const result = &results[result_index];
+                fprintf(file, "%s %.3lf %.3lf %zu\n", result->name, result->nanoseconds_per_operation, result->allocations_per_operation, result->vertex_count);
+        }
+
+        if (fclose(file)) {
+                send_message(MESSAGE_ERROR, "Failed to save baselines: Failed to write \"%s\": %s", path, strerror(errno));
+                return false;
+        }
+
+        send_message(MESSAGE_INFORMATION, "Saved baselines to \"%s\"", path);
+        return true;
+}
+
+// A benchmark regressed when it got slower than the threshold allows or allocates more than it did, vertex counts that changed
+// are only pointed out since tessellation changes are often the point of a change
+static bool report_results(void) {
+        size_t regression_count = 0ULL;
+
+        fprintf(stdout, "%-44s %14s %12s %10s%s\n", "Benchmark", "ns/op", "allocs/op", "vertices", baseline_path ? "   vs baseline" : "");
+        for (size_t result_index = 0ULL; result_index < result_count; ++result_index) {
+                const struct BenchmarkResult *const result = &results[result_index];
+                fprintf(stdout, "%-44s %14.1lf %12.2lf %10zu", result->name, result->nanoseconds_per_operation, result->allocations_per_operation, result->vertex_count);
+
+                const struct BenchmarkResult *const baseline = baseline_path ? find_baseline(result->name) : NULL;
+                if (baseline_path && !baseline) {
+                        fprintf(stdout, "   new");
+                }
+
+                if (baseline) {
+                        const double change = baseline->nanoseconds_per_operation > 0.0
+                                ? 100.0 * (result->nanoseconds_per_operation / baseline->nanoseconds_per_operation - 1.0)
+                                : 0.0;
+
+                        const bool slower = change > regression_percent;
+                        const bool allocating = result->allocations_per_operation > baseline->allocations_per_operation + 0.005;
+                        fprintf(stdout, "   %+7.1lf%%", change);
+
+                        if (slower || allocating) {
+                                fprintf(stdout, " REGRESSED%s", allocating ? " (allocations)" : "");
+                                ++regression_count;
+                        }
+
+                        if (result->vertex_count != baseline->vertex_count) {
+                                fprintf(stdout, " (vertices were %zu)", baseline->vertex_count);
+                        }
+                }
+
+                fprintf(stdout, "\n");
+        }
+
+        fflush(stdout);
+
+        if (regression_count) {
+                send_message(MESSAGE_ERROR, "%zu benchmarks regressed by more than %.1lf%% against \"%s\"", regression_count, regression_percent, baseline_path);
+                return false;
+        }
+
+        return true;
+}
@@ -2,6 +2,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #include "SDL.h"
@@ -18,6 +19,301 @@
 
 float ease(const float time, const enum Easing easing);
 
+// ================================================================================================
+// System
+// ================================================================================================
+
+// Action arrays of animations are carved out of fixed blocks that never move, and released ranges are kept per length so
+// that entities being created and destroyed on every level load reuse them instead of going through the allocator
+#define ACTION_BLOCK_SIZE           256ULL
+#define MAXIMUM_POOLED_ACTION_COUNT 8ULL
+
+static struct Action **action_blocks = NULL;
+static size_t action_block_count = 0ULL;
+static size_t action_block_used = ACTION_BLOCK_SIZE;
+
+static struct Action **free_action_ranges[MAXIMUM_POOLED_ACTION_COUNT + 1ULL];
+static size_t free_action_range_counts[MAXIMUM_POOLED_ACTION_COUNT + 1ULL];
+static size_t free_action_range_capacities[MAXIMUM_POOLED_ACTION_COUNT + 1ULL];
+
+// Only the animations that are running have a slot, the update is a sweep over these parallel arrays. Slots are released by
+// clearing their animation, since callbacks can stop animations in the middle of the sweep, and get compacted before the next one.
+static struct Animation **slot_animations = NULL;
+static float *slot_elapsed = NULL;
+static float *slot_delays = NULL;
+static float *slot_durations = NULL;
+static uint8_t *slot_easings = NULL;
+static bool *slot_unscaled = NULL;
+static size_t slot_count = 0ULL;
+static size_t slot_capacity = 0ULL;
+static size_t released_slot_count = 0ULL;
+
+// Scratch space of the update, the running slots are sorted by easing so each curve is evaluated over one contiguous run
+static float *sweep_progress = NULL;
+static float *batch_times = NULL;
+static float *batch_values = NULL;
+static size_t *batch_slots = NULL;
+static size_t *completed_slots = NULL;
+
+static struct Action *allocate_actions(const size_t action_count) {
+        if (!action_count || action_count > MAXIMUM_POOLED_ACTION_COUNT) {
+                return (struct Action *)xcalloc(action_count ? action_count : 1ULL, sizeof(struct Action));
+        }
+
+        struct Action *actions;
+        if (free_action_range_counts[action_count]) {
+                actions = free_action_ranges[action_count][--free_action_range_counts[action_count]];
+        } else {
+                if (action_block_used + action_count > ACTION_BLOCK_SIZE) {
+                        action_blocks = (struct Action **)xrealloc(action_blocks, sizeof(struct Action *) * (action_block_count + 1ULL));
+                        action_blocks[action_block_count++] = (struct Action *)xmalloc(sizeof(struct Action) * ACTION_BLOCK_SIZE);
+                        action_block_used = 0ULL;
+                }
+
+                actions = &action_blocks[action_block_count - 1ULL][action_block_used];
+                action_block_used += action_count;
+        }
+
+        memset(actions, 0, sizeof(struct Action) * action_count);
+        return actions;
+}
+
+static void release_actions(struct Action *const actions, const size_t action_count) {
+        if (!action_count || action_count > MAXIMUM_POOLED_ACTION_COUNT) {
+                xfree(actions);
+                return;
+        }
+
+        if (free_action_range_counts[action_count] == free_action_range_capacities[action_count]) {
+                const size_t capacity = free_action_range_capacities[action_count] ? free_action_range_capacities[action_count] * 2ULL : 16ULL;
+                free_action_ranges[action_count] = (struct Action **)xrealloc(free_action_ranges[action_count], sizeof(struct Action *) * capacity);
+                free_action_range_capacities[action_count] = capacity;
+        }
+
+        free_action_ranges[action_count][free_action_range_counts[action_count]++] = actions;
+}
+
+static void acquire_animation_slot(struct Animation *const animation) {
+        if (animation->slot != SIZE_MAX) {
+                return;
+        }
+
+        if (slot_count == slot_capacity) {
+                slot_capacity = slot_capacity ? slot_capacity * 2ULL : 64ULL;
+                slot_animations = (struct Animation **)xrealloc(slot_animations, sizeof(struct Animation *) * slot_capacity);
+                slot_elapsed    = (float *)xrealloc(slot_elapsed,    sizeof(float) * slot_capacity);
+                slot_delays     = (float *)xrealloc(slot_delays,     sizeof(float) * slot_capacity);
+                slot_durations  = (float *)xrealloc(slot_durations,  sizeof(float) * slot_capacity);
+                slot_easings    = (uint8_t *)xrealloc(slot_easings,  sizeof(uint8_t) * slot_capacity);
+                slot_unscaled   = (bool *)xrealloc(slot_unscaled,    sizeof(bool) * slot_capacity);
+                sweep_progress  = (float *)xrealloc(sweep_progress,  sizeof(float) * slot_capacity);
+                batch_times     = (float *)xrealloc(batch_times,     sizeof(float) * slot_capacity);
+                batch_values    = (float *)xrealloc(batch_values,    sizeof(float) * slot_capacity);
+                batch_slots     = (size_t *)xrealloc(batch_slots,    sizeof(size_t) * slot_capacity);
+                completed_slots = (size_t *)xrealloc(completed_slots, sizeof(size_t) * slot_capacity);
+        }
+
+        const struct Action *const action = &animation->actions[animation->action_index];
+        animation->slot = slot_count++;
+        slot_animations[animation->slot] = animation;
+        slot_elapsed[animation->slot] = animation->elapsed;
+        slot_delays[animation->slot] = action->delay;
+        slot_durations[animation->slot] = action->duration;
+        slot_easings[animation->slot] = (uint8_t)action->easing;
+        slot_unscaled[animation->slot] = animation->unscaled;
+}
+
+static void release_animation_slot(struct Animation *const animation) {
+        if (animation->slot == SIZE_MAX) {
+                return;
+        }
+
+        animation->elapsed = slot_elapsed[animation->slot];
+        slot_animations[animation->slot] = NULL;
+        animation->slot = SIZE_MAX;
+        ++released_slot_count;
+}
+
+static void compact_animation_slots(void) {
+        if (!released_slot_count) {
+                return;
+        }
+
+        size_t kept_count = 0ULL;
+        for (size_t slot = 0ULL; slot < slot_count; ++slot) {
+                struct Animation *const animation = slot_animations[slot];
+                if (!animation) {
+                        continue;
+                }
+
+                slot_animations[kept_count] = animation;
+                slot_elapsed[kept_count] = slot_elapsed[slot];
+                slot_delays[kept_count] = slot_delays[slot];
+                slot_durations[kept_count] = slot_durations[slot];
+                slot_easings[kept_count] = slot_easings[slot];
+                slot_unscaled[kept_count] = slot_unscaled[slot];
+                animation->slot = kept_count++;
+        }
+
+        slot_count = kept_count;
+        released_slot_count = 0ULL;
+}
+
+static void start_action(struct Action *const action);
+static void apply_action(struct Action *const action, const float value);
+static void complete_animation_action(struct Animation *const animation);
+
+// Interface animations (hovers, tooltips) advance by the real delta time, everything else follows the simulation's time scale
+void update_animation_system(const double delta_time, const double unscaled_delta_time) {
+        compact_animation_slots();
+
+        const float elapsed_time = (float)delta_time;
+        const float unscaled_elapsed_time = (float)unscaled_delta_time;
+
+        // Animations started by completion callbacks get a slot past the end and only run from the next update
+        const size_t swept_count = slot_count;
+        size_t completed_count = 0ULL;
+        size_t easing_counts[EASING_COUNT] = { 0ULL };
+
+        for (size_t slot = 0ULL; slot < swept_count; ++slot) {
+                sweep_progress[slot] = -1.0f;
+                if (!slot_animations[slot]) {
+                        continue;
+                }
+
+                slot_elapsed[slot] += slot_unscaled[slot] ? unscaled_elapsed_time : elapsed_time;
+                const float elapsed = slot_elapsed[slot] - slot_delays[slot];
+                if (elapsed <= 0.0f) {
+                        continue;
+                }
+
+                if (elapsed > slot_durations[slot]) {
+                        completed_slots[completed_count++] = slot;
+                        continue;
+                }
+
+                sweep_progress[slot] = elapsed / slot_durations[slot];
+                ++easing_counts[slot_easings[slot]];
+        }
+
+        size_t easing_offsets[EASING_COUNT];
+        size_t batch_count = 0ULL;
+        for (size_t easing = 0ULL; easing < EASING_COUNT; ++easing) {
+                easing_offsets[easing] = batch_count;
+                batch_count += easing_counts[easing];
+        }
+
+        for (size_t slot = 0ULL; slot < swept_count; ++slot) {
+                if (sweep_progress[slot] < 0.0f) {
+                        continue;
+                }
+
+                const size_t batch_index = easing_offsets[slot_easings[slot]]++;
+                batch_times[batch_index] = sweep_progress[slot];
+                batch_slots[batch_index] = slot;
+        }
+
+        size_t batch_start = 0ULL;
+        for (size_t easing = 0ULL; easing < EASING_COUNT; ++easing) {
+                if (easing_counts[easing]) {
+                        ease_batch((enum Easing)easing, &batch_times[batch_start], &batch_values[batch_start], easing_counts[easing]);
+                }
+
+                batch_start += easing_counts[easing];
+        }
+
+        for (size_t batch_index = 0ULL; batch_index < batch_count; ++batch_index) {
+                struct Animation *const animation = slot_animations[batch_slots[batch_index]];
+                apply_action(&animation->actions[animation->action_index], batch_values[batch_index]);
+        }
+
+        // Completions run last since their callbacks can start, stop or restart any animation. The time left over by an action
+        // carries into the next one, so a large delta steps through every action it covers, each being applied at its end and
+        // firing its callback in order, and only the action it lands in gets eased.
+        for (size_t completed_index = 0ULL; completed_index < completed_count; ++completed_index) {
+                const size_t slot = completed_slots[completed_index];
+                while (slot_animations[slot] && slot_elapsed[slot] - slot_delays[slot] > slot_durations[slot]) {
+                        complete_animation_action(slot_animations[slot]);
+                }
+
+                struct Animation *const animation = slot_animations[slot];
+                if (!animation || slot_elapsed[slot] <= slot_delays[slot]) {
+                        continue;
+                }
+
+                struct Action *const action = &animation->actions[animation->action_index];
+                const float progress = (slot_elapsed[slot] - slot_delays[slot]) / slot_durations[slot];
+                apply_action(action, ease(progress, action->easing));
+        }
+}
+
+bool is_animation_system_active(void) {
+        return slot_count > released_slot_count;
+}
+
+void terminate_animation_system(void) {
+        for (size_t slot = 0ULL; slot < slot_count; ++slot) {
+                if (slot_animations[slot]) {
+                        slot_animations[slot]->slot = SIZE_MAX;
+                }
+        }
+
+        if (slot_animations) {
+                xfree(slot_animations);
+                xfree(slot_elapsed);
+                xfree(slot_delays);
+                xfree(slot_durations);
+                xfree(slot_easings);
+                xfree(slot_unscaled);
+                xfree(sweep_progress);
+                xfree(batch_times);
+                xfree(batch_values);
+                xfree(batch_slots);
+                xfree(completed_slots);
+        }
+
+        slot_animations = NULL;
+        slot_elapsed = NULL;
+        slot_delays = NULL;
+        slot_durations = NULL;
+        slot_easings = NULL;
+        slot_unscaled = NULL;
+        sweep_progress = NULL;
+        batch_times = NULL;
+        batch_values = NULL;
+        batch_slots = NULL;
+        completed_slots = NULL;
+        slot_count = 0ULL;
+        slot_capacity = 0ULL;
+        released_slot_count = 0ULL;
+
+        for (size_t action_count = 0ULL; action_count <= MAXIMUM_POOLED_ACTION_COUNT; ++action_count) {
+                if (free_action_ranges[action_count]) {
+                        xfree(free_action_ranges[action_count]);
+                }
+
+                free_action_ranges[action_count] = NULL;
+                free_action_range_counts[action_count] = 0ULL;
+                free_action_range_capacities[action_count] = 0ULL;
+        }
+
+        for (size_t block_index = 0ULL; block_index < action_block_count; ++block_index) {
+                xfree(action_blocks[block_index]);
+        }
+
+        if (action_blocks) {
+                xfree(action_blocks);
+        }
+
+        action_blocks = NULL;
+        action_block_count = 0ULL;
+        action_block_used = ACTION_BLOCK_SIZE;
+}
+
+// ================================================================================================
+// Animation
+// ================================================================================================
+
 struct Animation *create_animation(const size_t action_count) {
         struct Animation *const animation = (struct Animation *)xmalloc(sizeof(struct Animation));
         initialize_animation(animation, action_count);
@@ -35,10 +331,13 @@ void destroy_animation(struct Animation *const animation) {
 }
 
 void initialize_animation(struct Animation *const animation, const size_t action_count) {
-        animation->actions = (struct Action *)xcalloc(action_count, sizeof(struct Action));
+        animation->actions = allocate_actions(action_count);
         animation->action_count = action_count;
         animation->action_index = SIZE_MAX;
+        animation->elapsed = 0.0f;
+        animation->slot = SIZE_MAX;
         animation->active = false;
+        animation->unscaled = false;
 }
 
 void deinitialize_animation(struct Animation *const animation) {
@@ -47,37 +346,32 @@ void deinitialize_animation(struct Animation *const animation) {
                 return;
         }
 
-        xfree(animation->actions);
+        release_animation_slot(animation);
+        release_actions(animation->actions, animation->action_count);
         animation->actions = NULL;
 }
 
-static void start_action(struct Action *const action);
-
 void start_animation(struct Animation *const animation, const size_t action_index) {
         animation->active = true;
 
         if (animation->action_index == SIZE_MAX) {
                 animation->action_index = action_index;
+                animation->elapsed = 0.0f;
                 start_action(&animation->actions[action_index]);
         }
+
+        acquire_animation_slot(animation);
 }
 
 void stop_animation(struct Animation *const animation) {
         animation->active = false;
+        release_animation_slot(animation);
 }
 
 void reset_animation(struct Animation *const animation) {
         stop_animation(animation);
-
-        if (animation->action_index == SIZE_MAX) {
-                return;
-        }
-
-        for (size_t action_index = 0ULL; action_index < animation->action_index; ++action_index) {
-                animation->actions[action_index].elapsed = 0.0f;
-        }
-
         animation->action_index = SIZE_MAX;
+        animation->elapsed = 0.0f;
 }
 
 void restart_animation(struct Animation *const animation, const size_t action_index) {
@@ -85,45 +379,50 @@ void restart_animation(struct Animation *const animation, const size_t action_in
         start_animation(animation, action_index);
 }
 
-static void apply_action(struct Action *const action, const float value);
-
-void update_animation(struct Animation *const animation, const double delta_time) {
-        if (!animation->active) {
-                return;
+void finish_animation(struct Animation *const animation) {
+        // Bounded by the action count so that a callback restarting its own animation cannot keep this going forever
+        for (size_t step = 0ULL; step < animation->action_count && animation->slot != SIZE_MAX; ++step) {
+                const size_t slot = animation->slot;
+                slot_elapsed[slot] = slot_delays[slot] + slot_durations[slot];
+                complete_animation_action(animation);
         }
+}
 
-        struct Action *const current_action = &animation->actions[animation->action_index];
+static void complete_animation_action(struct Animation *const animation) {
+        const size_t slot = animation->slot;
+        const size_t action_index = animation->action_index;
+        struct Action *const current_action = &animation->actions[action_index];
+        const float leftover_elapsed = slot_elapsed[slot] - current_action->delay - current_action->duration;
 
-        current_action->elapsed += (float)delta_time;
-        if (current_action->elapsed <= current_action->delay) {
-                return;
+        apply_action(current_action, 1.0f);
+        if (current_action->completion_callback) {
+                current_action->completion_callback(current_action->completion_callback_data);
         }
 
-        const float elapsed = current_action->elapsed - current_action->delay;
-        if (elapsed > current_action->duration) {
-                apply_action(current_action, 1.0f);
-                if (current_action->completion_callback) {
-                        current_action->completion_callback(current_action->completion_callback_data);
-                }
-
-                if (++animation->action_index >= animation->action_count) {
-                        reset_animation(animation);
-                        return;
-                }
+        // The callback may have restarted or stopped the animation, which then already is where it wants to be
+        if (animation->slot != slot || animation->action_index != action_index) {
+                return;
+        }
 
-                if (current_action->pause) {
-                        stop_animation(animation);
-                        return;
-                }
+        if (++animation->action_index >= animation->action_count) {
+                reset_animation(animation);
+                return;
+        }
 
-                start_action(&animation->actions[animation->action_index]);
-                update_animation(animation, current_action->duration - elapsed);
+        if (current_action->pause) {
+                slot_elapsed[slot] = 0.0f;
+                stop_animation(animation);
                 return;
         }
 
-        const float progress = elapsed / current_action->duration;
-        const float value = ease(progress, current_action->easing);
-        apply_action(current_action, value);
+        slot_elapsed[slot] = leftover_elapsed;
+
+        struct Action *const next_action = &animation->actions[animation->action_index];
+        start_action(next_action);
+
+        slot_delays[slot] = next_action->delay;
+        slot_durations[slot] = next_action->duration;
+        slot_easings[slot] = (uint8_t)next_action->easing;
 }
 
 static void start_action(struct Action *const action) {
@@ -161,6 +460,29 @@ static void start_action(struct Action *const action) {
                         action->keyframes.colors[0] = *action->target.color_pointer;
                         break;
                 }
+
+                case ACTION_TEXT_COLOR: {
+                        if (!action->target.text_pointer) {
+                                send_message(MESSAGE_ERROR, "Failed to start action: The text pointer referencing the start keyframe is NULL");
+                                return;
+                        }
+
+                        SDL_Color *const color = &action->keyframes.colors[0];
+                        get_text_color(action->target.text_pointer, &color->r, &color->g, &color->b, &color->a);
+                        break;
+                }
+
+                case ACTION_TEXT_ALPHA: {
+                        if (!action->target.text_pointer) {
+                                send_message(MESSAGE_ERROR, "Failed to start action: The text pointer referencing the start keyframe is NULL");
+                                return;
+                        }
+
+                        uint8_t alpha;
+                        get_text_color(action->target.text_pointer, NULL, NULL, NULL, &alpha);
+                        action->keyframes.floats[0] = (float)alpha / 255.0f;
+                        break;
+                }
         }
 }
 
@@ -190,6 +512,28 @@ static void apply_action(struct Action *const action, const float value) {
                         (*action->target.color_pointer).a = a.a + (Uint8)lroundf(value * (float)(action->offset ? b.a : b.a - a.a));
                         break;
                 }
+
+                // Text is tinted when it is drawn, so these only change the vertex colors and never re-rasterize anything
+                case ACTION_TEXT_COLOR: {
+                        const SDL_Color a = action->keyframes.colors[0];
+                        const SDL_Color b = action->keyframes.colors[1];
+                        set_text_color(
+                                action->target.text_pointer,
+                                a.r + (Uint8)lroundf(value * (float)(action->offset ? b.r : b.r - a.r)),
+                                a.g + (Uint8)lroundf(value * (float)(action->offset ? b.g : b.g - a.g)),
+                                a.b + (Uint8)lroundf(value * (float)(action->offset ? b.b : b.b - a.b)),
+                                a.a + (Uint8)lroundf(value * (float)(action->offset ? b.a : b.a - a.a))
+                        );
+                        break;
+                }
+
+                case ACTION_TEXT_ALPHA: {
+                        const float a = action->keyframes.floats[0];
+                        const float b = action->keyframes.floats[1];
+                        const float alpha = a + value * (action->offset ? b : b - a);
+                        set_text_alpha(action->target.text_pointer, (uint8_t)lroundf(CLAMP_VALUE(alpha, 0.0f, 1.0f) * 255.0f));
+                        break;
+                }
         }
 }
 
@@ -277,4 +621,141 @@ float ease(const float time, const enum Easing easing) {
                         return (powf(f, 2.0f) * ((C2 + 1.0f) * f + C2) + 2.0f) / 2.0f;
                 }
         }
-}
\ No newline at end of file
+}
+// ================================================================================================
+// Batched Easing
+// ================================================================================================
+
+// Each curve is a branch-free loop over contiguous floats so the compiler can vectorize it, the sine curves use a polynomial
+// (Abramowitz and Stegun 4.3.97, error below 1e-8 on [-pi/2, pi/2]) instead of calling sinf() and cosf() per element
+static inline float approximate_sine(const float x) {
+        const float x2 = x * x;
+        return x * (1.0f + x2 * (-0.1666666664f + x2 * (0.0083333315f + x2 * (-0.0001984090f + x2 * (0.0000027526f + x2 * -0.0000000239f)))));
+}
+
+void ease_batch(const enum Easing easing, const float *const times, float *const values, const size_t count) {
+        // Folded once so the unparenthesized constants above cannot be split by the surrounding products
+        const float c1 = C1;
+        const float c2 = C2;
+        const float c3 = C3;
+        const float half_pi = (float)M_PI / 2.0f;
+
+        switch (easing) {
+                case LINEAR: {
+                        memcpy(values, times, sizeof(float) * count);
+                        return;
+                }
+
+                case QUAD_IN: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float t = times[index];
+                                values[index] = t * t;
+                        }
+
+                        return;
+                }
+
+                case QUAD_OUT: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float t = times[index];
+                                values[index] = t * (2.0f - t);
+                        }
+
+                        return;
+                }
+
+                case QUAD_IN_OUT: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float t = times[index];
+                                values[index] = t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - t * 2.0f) * t;
+                        }
+
+                        return;
+                }
+
+                case CUBE_IN: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float t = times[index];
+                                values[index] = t * t * t;
+                        }
+
+                        return;
+                }
+
+                case CUBE_OUT: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float f = times[index] - 1.0f;
+                                values[index] = f * f * f + 1.0f;
+                        }
+
+                        return;
+                }
+
+                case CUBE_IN_OUT: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float t = times[index];
+                                const float f = t * 2.0f - 2.0f;
+                                values[index] = t < 0.5f ? t * t * t * 4.0f : f * f * f / 2.0f + 1.0f;
+                        }
+
+                        return;
+                }
+
+                case SINE_IN: {
+                        // 1 - cos(t * pi / 2) = 1 - sin((1 - t) * pi / 2)
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                values[index] = 1.0f - approximate_sine((1.0f - times[index]) * half_pi);
+                        }
+
+                        return;
+                }
+
+                case SINE_OUT: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                values[index] = approximate_sine(times[index] * half_pi);
+                        }
+
+                        return;
+                }
+
+                case SINE_IN_OUT: {
+                        // (1 - cos(t * pi)) / 2 = (1 - sin(pi / 2 - t * pi)) / 2
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                values[index] = (1.0f - approximate_sine(half_pi - times[index] * (float)M_PI)) / 2.0f;
+                        }
+
+                        return;
+                }
+
+                case BACK_IN: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float t = times[index];
+                                values[index] = t * t * (c3 * t - c1);
+                        }
+
+                        return;
+                }
+
+                case BACK_OUT: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float y = times[index] - 1.0f;
+                                values[index] = 1.0f + y * y * (c3 * y + c1);
+                        }
+
+                        return;
+                }
+
+                case BACK_IN_OUT: {
+                        for (size_t index = 0ULL; index < count; ++index) {
+                                const float t = times[index];
+                                const float u = t * 2.0f;
+                                const float f = u - 2.0f;
+                                const float first_half = u * u * ((c2 + 1.0f) * u - c2) / 2.0f;
+                                const float second_half = (f * f * ((c2 + 1.0f) * f + c2) + 2.0f) / 2.0f;
+                                values[index] = t < 0.5f ? first_half : second_half;
+                        }
+
+                        return;
+                }
+        }
+}
@@ -5,6 +5,9 @@
 
 #include "SDL.h"
 
+#include "Text.h"
+
+#define EASING_COUNT 13ULL
 enum Easing {
         LINEAR,
         QUAD_IN,
@@ -22,11 +25,14 @@ enum Easing {
 };
 
 float ease(const float time, const enum Easing easing);
+void ease_batch(const enum Easing easing, const float *const times, float *const values, const size_t count);
 
 enum ActionType {
         ACTION_FLOAT,
         ACTION_POINT,
-        ACTION_COLOR
+        ACTION_COLOR,
+        ACTION_TEXT_COLOR,
+        ACTION_TEXT_ALPHA
 };
 
 struct Action {
@@ -38,12 +44,12 @@ struct Action {
         bool offset;
         bool pause;
         float duration;
-        float elapsed;
         float delay;
         union {
                 float *float_pointer;
                 SDL_FPoint *point_pointer;
                 SDL_Color *color_pointer;
+                struct Text *text_pointer;
         } target;
         union {
                 float floats[2];
@@ -56,9 +62,16 @@ struct Animation {
         struct Action *actions;
         size_t action_count;
         size_t action_index;
+        float elapsed;
+        size_t slot;
         bool active;
+        bool unscaled;
 };
 
+void update_animation_system(const double delta_time, const double unscaled_delta_time);
+bool is_animation_system_active(void);
+void terminate_animation_system(void);
+
 struct Animation *create_animation(const size_t action_count);
 void destroy_animation(struct Animation *const animation);
 
@@ -68,5 +81,5 @@ void deinitialize_animation(struct Animation *const animation);
 void start_animation(struct Animation *const animation, const size_t action_index);
 void stop_animation(struct Animation *const animation);
 void reset_animation(struct Animation *const animation);
-void update_animation(struct Animation *const animation, const double delta_time);
-void restart_animation(struct Animation *const animation, const size_t action_index);
\ No newline at end of file
+void restart_animation(struct Animation *const animation, const size_t action_index);
+void finish_animation(struct Animation *const animation);
\ No newline at end of file
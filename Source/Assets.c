@@ -59,6 +59,9 @@ void unload_assets(void) {
 // ================================================================================================
 
 static TTF_Font *fonts[FONT_COUNT];
+static char *font_file_paths[FONT_COUNT];
+static int font_point_sizes[FONT_COUNT];
+static float font_scale = 1.0f;
 static size_t font_sizes[FONT_COUNT] = {
         [FONT_TITLE]    = 48ULL,
         [FONT_HEADER_1] = 36ULL,
@@ -83,6 +86,29 @@ TTF_Font *get_font(const enum Font font) {
         return fonts[font];
 }
 
+const char *get_font_path(const enum Font font) {
+        return font_file_paths[font];
+}
+
+int get_font_point_size(const enum Font font) {
+        return font_point_sizes[font];
+}
+
+float get_font_scale(void) {
+        return font_scale;
+}
+
+TTF_Font *open_font_instance(const enum Font font) {
+        TTF_Font *const instance = TTF_OpenFont(font_file_paths[font], font_point_sizes[font]);
+        if (!instance) {
+                send_message(MESSAGE_ERROR, "Failed to open font instance %d: %s", (int)font, TTF_GetMESSAGE_ERROR());
+                return NULL;
+        }
+
+        TTF_SetFontKerning(instance, (int)font_kerning_allowed[font]);
+        return instance;
+}
+
 static bool load_fonts(const cJSON *const json) {
         if (!cJSON_IsObject(json)) {
                 send_message(MESSAGE_ERROR, "Failed to load fonts: JSON data is invalid");
@@ -110,12 +136,15 @@ static bool load_fonts(const cJSON *const json) {
 
         int window_height;
         int drawable_height;
-        SDL_GetWindowSize(get_context_window(), NULL, &window_height);
-        SDL_GetRendererOutputSize(get_context_renderer(), NULL, &drawable_height);
+        get_context_window_size(NULL, &window_height);
+        get_context_drawable_size(NULL, &drawable_height);
 
         const float scale = (float)drawable_height / (float)window_height;
+        font_scale = scale;
         for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
-                if (!(fonts[font_index] = TTF_OpenFont(font_paths[font_index], (int)(font_sizes[font_index] * scale)))) {
+                font_file_paths[font_index] = xstrdup(font_paths[font_index]);
+                font_point_sizes[font_index] = (int)(font_sizes[font_index] * scale);
+                if (!(fonts[font_index] = TTF_OpenFont(font_file_paths[font_index], font_point_sizes[font_index]))) {
                         send_message(MESSAGE_ERROR, "Failed to load fonts: Failed to open font %zu: %s", font_index, TTF_GetMESSAGE_ERROR());
                         return false;
                 }
@@ -130,6 +159,11 @@ static void unload_fonts(void) {
         for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
                 TTF_CloseFont(fonts[font_index]);
                 fonts[font_index] = NULL;
+
+                if (font_file_paths[font_index]) {
+                        xfree(font_file_paths[font_index]);
+                        font_file_paths[font_index] = NULL;
+                }
         }
 }
 
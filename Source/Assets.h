@@ -23,6 +23,10 @@ enum Font {
 
 typedef struct TTF_Font TTF_Font;
 TTF_Font *get_font(const enum Font font);
+TTF_Font *open_font_instance(const enum Font font);
+const char *get_font_path(const enum Font font);
+int get_font_point_size(const enum Font font);
+float get_font_scale(void);
 
 // ================================================================================================
 // Levels
@@ -5,6 +5,7 @@
 #include "SDL_mixer.h"
 
 #include "Debug.h"
+#include "Context.h"
 #include "Persistent.h"
 
 #define SOUND_CHANNEL_COUNT 4
@@ -13,6 +14,9 @@
 static Mix_Chunk *sound_chunks[SOUND_COUNT];
 static Mix_Music *music_tracks[MUSIC_COUNT];
 
+// Stays false when audio is never initialized (headless mode), which turns every call below into a no-op
+static bool audio_initialized = false;
+
 static const char *sound_paths[SOUND_COUNT] = {
         "Assets/Audio/Click.wav",
         "Assets/Audio/Hit.wav",
@@ -34,6 +38,7 @@ bool initialize_audio(void) {
                 return false;
         }
 
+        audio_initialized = true;
         Mix_AllocateChannels(SOUND_CHANNEL_COUNT);
         Mix_GroupChannels(0, SOUND_CHANNEL_COUNT - 1, SOUND_GROUP);
 
@@ -79,10 +84,16 @@ void terminate_audio(void) {
                 }
         }
 
+        audio_initialized = false;
         Mix_Quit();
 }
 
 void play_sound(const enum Sound sound) {
+        // Fast-forwarded playback would only pile up overlapping sounds on the few channels there are
+        if (!audio_initialized || is_context_fast_forwarding()) {
+                return;
+        }
+
         if (!sound_chunks[sound]) {
                 send_message(MESSAGE_ERROR, "Failed to play sound %d: Sound is unavailable", (int)sound);
                 return;
@@ -95,12 +106,20 @@ void play_sound(const enum Sound sound) {
 }
 
 void toggle_sound(const bool enabled) {
+        if (!audio_initialized) {
+                return;
+        }
+
         for (int channel = 0; channel < SOUND_CHANNEL_COUNT; ++channel) {
                 Mix_Volume(channel, enabled ? MIX_MAX_VOLUME : 0);
         }
 }
 
 void play_music(const enum Music music) {
+        if (!audio_initialized) {
+                return;
+        }
+
         if (!music_tracks[music]) {
                 send_message(MESSAGE_ERROR, "Failed to play music %d: Music is unavailable", (int)music);
                 return;
@@ -112,5 +131,9 @@ void play_music(const enum Music music) {
 }
 
 void toggle_music(const bool enabled) {
+        if (!audio_initialized) {
+                return;
+        }
+
         Mix_VolumeMusic(enabled ? MIX_MAX_VOLUME : 0);
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #include "Hexagons.h"
 #include "Icons.h"
 #include "Text.h"
+#include "Jobs.h"
 
 #define PADDING_FACTOR 0.02f
 #define MINIMUM_PADDING 20.0f
@@ -29,6 +30,12 @@ enum ButtonState {
 struct ButtonImplementation {
         enum ButtonState state;
         struct Geometry *geometry;
+        struct JobBatch tessellation;
+        bool outdated_geometry;
+        float geometry_x;
+        float geometry_y;
+        float geometry_radius;
+        enum HexagonThicknessMask geometry_thickness_mask;
         struct Animation animations;
         float animation_offset;
         float computed_radius;
@@ -75,6 +82,12 @@ void initialize_button(struct Button *const button, const bool grid_slot_positio
 
         button->implementation = (struct ButtonImplementation *)xmalloc(sizeof(struct ButtonImplementation));
         button->implementation->geometry = create_geometry();
+        SDL_AtomicSet(&button->implementation->tessellation.remaining_jobs, 0);
+        button->implementation->outdated_geometry = true;
+        button->implementation->geometry_x = 0.0f;
+        button->implementation->geometry_y = 0.0f;
+        button->implementation->geometry_radius = 0.0f;
+        button->implementation->geometry_thickness_mask = HEXAGON_THICKNESS_MASK_NONE;
         button->implementation->state = BUTTON_IDLE;
         button->implementation->hovering = false;
         button->implementation->tooltip_text = NULL;
@@ -83,6 +96,7 @@ void initialize_button(struct Button *const button, const bool grid_slot_positio
         button->implementation->surface_icon = NULL;
         button->implementation->surface_text = NULL;
         initialize_animation(&button->implementation->animations, BUTTON_STATE_COUNT);
+        button->implementation->animations.unscaled = true;
 
         struct Action *const idle = &button->implementation->animations.actions[BUTTON_IDLE];
         idle->target.float_pointer = &button->implementation->animation_offset;
@@ -122,6 +136,7 @@ void deinitialize_button(struct Button *const button) {
         }
 
         if (button->implementation) {
+                wait_for_job_batch(&button->implementation->tessellation);
                 deinitialize_animation(&button->implementation->animations);
                 destroy_geometry(button->implementation->geometry);
 
@@ -166,7 +181,7 @@ void get_button_metrics(const struct Button *const button, float *const out_x, f
 
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
 
         if (out_x != NULL) {
                 *out_x =
@@ -238,14 +253,14 @@ bool button_receive_event(struct Button *const button, const SDL_Event *const ev
         ) {
                 int drawable_width;
                 int drawable_height;
-                SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+                get_context_drawable_size(&drawable_width, &drawable_height);
 
                 float target_x;
                 float target_y;
                 if (event->type == SDL_MOUSEBUTTONDOWN || event->type == SDL_MOUSEMOTION || event->type == SDL_MOUSEBUTTONUP) {
                         int window_width;
                         int window_height;
-                        SDL_GetWindowSize(get_context_window(), &window_width, &window_height);
+                        get_context_window_size(&window_width, &window_height);
                         target_x = event->button.x * (float)drawable_width / (float)window_width;
                         target_y = event->button.y * (float)drawable_height / (float)window_height;
                 } else {
@@ -312,33 +327,57 @@ bool button_receive_event(struct Button *const button, const SDL_Event *const ev
         return false;
 }
 
-bool update_button(struct Button *const button, const double delta_time) {
-        update_animation(&button->implementation->animations, delta_time);
+// Runs as a job, with the position and size the geometry was last requested at
+static void write_button_geometry(void *const data) {
+        struct ButtonImplementation *const implementation = (struct ButtonImplementation *)data;
+
+        const float radius = implementation->geometry_radius;
+        const float thickness = radius / 2.0f;
+        const float line_width = radius / 5.0f;
+        const float surface_x = implementation->geometry_x;
+        const float surface_y = implementation->geometry_y;
+
+        clear_geometry(implementation->geometry);
+
+        set_geometry_color(implementation->geometry, COLOR_GOLD, COLOR_OPAQUE);
+        write_hexagon_thickness_geometry(implementation->geometry, surface_x, surface_y, radius + line_width / 2.0f, thickness, implementation->geometry_thickness_mask);
+
+        set_geometry_color(implementation->geometry, COLOR_LIGHT_YELLOW, COLOR_OPAQUE);
+        write_hexagon_geometry(implementation->geometry, surface_x, surface_y, radius + line_width / 2.0f, 0.0f);
 
-        clear_geometry(button->implementation->geometry);
+        set_geometry_color(implementation->geometry, COLOR_YELLOW, COLOR_OPAQUE);
+        write_hexagon_geometry(implementation->geometry, surface_x, surface_y, radius - line_width / 2.0f, 0.0f);
+}
 
+bool update_button(struct Button *const button, const double delta_time) {
         float x;
         float y;
         float radius;
         get_button_metrics(button, &x, &y, &radius);
 
         const float thickness = radius / 2.0f;
-        const float line_width = radius / 5.0f;
         const float height_offset = button->implementation->animation_offset * thickness;
 
         const float surface_x = x;
         const float surface_y = y - height_offset;
 
-        set_geometry_color(button->implementation->geometry, COLOR_GOLD, COLOR_OPAQUE);
-        write_hexagon_thickness_geometry(button->implementation->geometry, surface_x, surface_y, radius + line_width / 2.0f, thickness, button->thickness_mask);
-
-        set_geometry_color(button->implementation->geometry, COLOR_LIGHT_YELLOW, COLOR_OPAQUE);
-        write_hexagon_geometry(button->implementation->geometry, surface_x, surface_y, radius + line_width / 2.0f, 0.0f);
-
-        set_geometry_color(button->implementation->geometry, COLOR_YELLOW, COLOR_OPAQUE);
-        write_hexagon_geometry(button->implementation->geometry, surface_x, surface_y, radius - line_width / 2.0f, 0.0f);
-
-        render_geometry(button->implementation->geometry);
+        if (
+                button->implementation->outdated_geometry ||
+                button->implementation->geometry_radius != radius ||
+                button->implementation->geometry_thickness_mask != button->thickness_mask
+        ) {
+                button->implementation->outdated_geometry = false;
+                button->implementation->geometry_x = surface_x;
+                button->implementation->geometry_y = surface_y;
+                button->implementation->geometry_radius = radius;
+                button->implementation->geometry_thickness_mask = button->thickness_mask;
+                submit_job(&button->implementation->tessellation, "write_button_geometry", write_button_geometry, button->implementation);
+        } else if (button->implementation->geometry_x != surface_x || button->implementation->geometry_y != surface_y) {
+                // Hovering and pressing only move the hexagons up and down, so the existing geometry can just be shifted
+                translate_geometry(button->implementation->geometry, surface_x - button->implementation->geometry_x, surface_y - button->implementation->geometry_y);
+                button->implementation->geometry_x = surface_x;
+                button->implementation->geometry_y = surface_y;
+        }
 
         if (button->implementation->surface_icon) {
                 set_icon_position(button->implementation->surface_icon, surface_x, surface_y);
@@ -351,7 +390,6 @@ bool update_button(struct Button *const button, const double delta_time) {
                 button->implementation->surface_text->absolute_offset_y = surface_y;
                 button->implementation->surface_text->scale_x = button->scale * radius / 100.0f;
                 button->implementation->surface_text->scale_y = button->scale * radius / 100.0f;
-                update_text(button->implementation->surface_text);
         }
 
         if (button->implementation->hovering) {
@@ -366,13 +404,27 @@ bool update_button(struct Button *const button, const double delta_time) {
         return true;
 }
 
+void render_button(struct Button *const button) {
+        wait_for_job_batch(&button->implementation->tessellation);
+        render_geometry(button->implementation->geometry);
+
+        if (button->implementation->surface_icon) {
+                render_icon(button->implementation->surface_icon);
+        }
+
+        if (button->implementation->surface_text) {
+                update_text(button->implementation->surface_text);
+        }
+}
+
 static void resize_button(struct Button *const button) {
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
 
         const float padding = CLAMP_VALUE(fmaxf((float)drawable_width, (float)drawable_height) * PADDING_FACTOR, MINIMUM_PADDING, MAXIMUM_PADDING);
         button->implementation->computed_radius = padding;
+        button->implementation->outdated_geometry = true;
 
         if (button->implementation->grid_metrics) {
                 button->implementation->grid_metrics->bounding_width  = (float)drawable_width  - padding * 2.0f;
@@ -38,4 +38,5 @@ void set_button_surface_icon(struct Button *const button, const enum IconType ic
 bool set_button_surface_text(struct Button *const button, char *const surface_text);
 void set_button_tooltip_text(struct Button *const button, char *const tooltip_text);
 bool button_receive_event(struct Button *const button, const SDL_Event *const event);
-bool update_button(struct Button *const button, const double delta_time);
\ No newline at end of file
+bool update_button(struct Button *const button, const double delta_time);
+void render_button(struct Button *const button);
\ No newline at end of file
@@ -16,6 +16,23 @@
 static SDL_Window *window = NULL;
 static SDL_Renderer *renderer = NULL;
 static SDL_Texture *missing_texture = NULL;
+static bool vsynced = false;
+
+// Sizes are only queried by the render thread between frames, the simulation reads these copies
+static int window_width = 0;
+static int window_height = 0;
+static int drawable_width = 0;
+static int drawable_height = 0;
+
+// Only used in headless mode, where the software renderer draws straight into it instead of into a window
+static SDL_Surface *headless_surface = NULL;
+
+static float time_scale = 1.0f;
+
+// Set by anything that changes on screen without an animation or an event behind it, cleared once per frame by the main loop
+static bool redraw_requested = false;
+
+static bool initialize_context_resources(void);
 
 SDL_Window *get_context_window(void) {
         return window;
@@ -29,7 +46,79 @@ SDL_Texture *get_mising_texture(void) {
         return missing_texture;
 }
 
-bool initialize_context(void) {
+bool is_context_headless(void) {
+        return headless_surface != NULL;
+}
+
+bool is_context_vsynced(void) {
+        return vsynced;
+}
+
+int get_context_refresh_rate(void) {
+        SDL_DisplayMode display_mode;
+        if (!window || SDL_GetWindowDisplayMode(window, &display_mode) != 0) {
+                return 0;
+        }
+
+        return display_mode.refresh_rate;
+}
+
+void set_context_time_scale(const float scale) {
+        time_scale = CLAMP_VALUE(scale, 0.0f, UNBOUNDED_TIME_SCALE);
+}
+
+float get_context_time_scale(void) {
+        return time_scale;
+}
+
+bool is_context_fast_forwarding(void) {
+        return time_scale > FAST_FORWARD_TIME_SCALE;
+}
+
+void request_context_redraw(void) {
+        redraw_requested = true;
+}
+
+bool consume_context_redraw(void) {
+        const bool requested = redraw_requested;
+        redraw_requested = false;
+        return requested;
+}
+
+void refresh_context_size(void) {
+        if (headless_surface) {
+                window_width = headless_surface->w;
+                window_height = headless_surface->h;
+        } else if (window) {
+                SDL_GetWindowSize(window, &window_width, &window_height);
+        }
+
+        if (renderer) {
+                SDL_GetRendererOutputSize(renderer, &drawable_width, &drawable_height);
+        }
+}
+
+void get_context_window_size(int *const out_width, int *const out_height) {
+        if (out_width != NULL) {
+                *out_width = window_width;
+        }
+
+        if (out_height != NULL) {
+                *out_height = window_height;
+        }
+}
+
+void get_context_drawable_size(int *const out_width, int *const out_height) {
+        if (out_width != NULL) {
+                *out_width = drawable_width;
+        }
+
+        if (out_height != NULL) {
+                *out_height = drawable_height;
+        }
+}
+
+bool initialize_context(const bool vsync) {
         if (!(window = SDL_CreateWindow("Sokobee", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, INITIAL_WINDOW_WIDTH, INITIAL_WINDOW_HEIGHT, SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI))) {
                 send_message(MESSAGE_ERROR, "Failed to initialize context: Failed to create window: %s", SDL_GetMESSAGE_ERROR());
                 terminate_context();
@@ -38,13 +127,42 @@ bool initialize_context(void) {
 
         SDL_SetWindowMinimumSize(window, MINIMUM_WINDOW_WIDTH, MINIMUM_WINDOW_HEIGHT);
 
-        if (!(renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED))) {
+        // Some drivers refuse vsync outright, in which case the frames get paced by the main loop instead
+        if (vsync && !(renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC))) {
+                send_message(MESSAGE_WARNING, "Failed to create renderer with vsync: %s", SDL_GetMESSAGE_ERROR());
+        }
+
+        if (!renderer && !(renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED))) {
                 send_message(MESSAGE_ERROR, "Failed to initialize context: Failed to create renderer: %s", SDL_GetMESSAGE_ERROR());
                 terminate_context();
                 return false;
         }
 
+        SDL_RendererInfo renderer_info;
+        vsynced = SDL_GetRendererInfo(renderer, &renderer_info) == 0 && (renderer_info.flags & SDL_RENDERER_PRESENTVSYNC);
+
+        return initialize_context_resources();
+}
+
+bool initialize_headless_context(const int width, const int height) {
+        if (!(headless_surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888))) {
+                send_message(MESSAGE_ERROR, "Failed to initialize headless context: Failed to create surface: %s", SDL_GetMESSAGE_ERROR());
+                terminate_context();
+                return false;
+        }
+
+        if (!(renderer = SDL_CreateSoftwareRenderer(headless_surface))) {
+                send_message(MESSAGE_ERROR, "Failed to initialize headless context: Failed to create software renderer: %s", SDL_GetMESSAGE_ERROR());
+                terminate_context();
+                return false;
+        }
+
+        return initialize_context_resources();
+}
+
+static bool initialize_context_resources(void) {
         SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        refresh_context_size();
 
         if (!(missing_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, MISSING_TEXTURE_WIDTH, MISSING_TEXTURE_HEIGHT))) {
                 send_message(MESSAGE_ERROR, "Failed to initialize context: Failed to create missing texture: %s", SDL_GetMESSAGE_ERROR());
@@ -76,6 +194,55 @@ void terminate_context(void) {
                 SDL_DestroyWindow(window);
                 window = NULL;
         }
+
+        if (headless_surface) {
+                SDL_FreeSurface(headless_surface);
+                headless_surface = NULL;
+        }
+
+        vsynced = false;
+        window_width = 0;
+        window_height = 0;
+        drawable_width = 0;
+        drawable_height = 0;
+}
+
+bool save_context_frame(const char *const path) {
+        // Has to be called before the frame is presented, since the contents of the back buffer are undefined afterwards
+        if (headless_surface) {
+                SDL_RenderFlush(renderer);
+                if (SDL_SaveBMP(headless_surface, path) < 0) {
+                        send_message(MESSAGE_ERROR, "Failed to save frame to \"%s\": %s", path, SDL_GetMESSAGE_ERROR());
+                        return false;
+                }
+
+                return true;
+        }
+
+        int output_width;
+        int output_height;
+        SDL_GetRendererOutputSize(renderer, &output_width, &output_height);
+
+        SDL_Surface *const surface = SDL_CreateRGBSurfaceWithFormat(0, output_width, output_height, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!surface) {
+                send_message(MESSAGE_ERROR, "Failed to save frame to \"%s\": Failed to create surface: %s", path, SDL_GetMESSAGE_ERROR());
+                return false;
+        }
+
+        if (SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, surface->pixels, surface->pitch) < 0) {
+                send_message(MESSAGE_ERROR, "Failed to save frame to \"%s\": Failed to read pixels: %s", path, SDL_GetMESSAGE_ERROR());
+                SDL_FreeSurface(surface);
+                return false;
+        }
+
+        if (SDL_SaveBMP(surface, path) < 0) {
+                send_message(MESSAGE_ERROR, "Failed to save frame to \"%s\": %s", path, SDL_GetMESSAGE_ERROR());
+                SDL_FreeSurface(surface);
+                return false;
+        }
+
+        SDL_FreeSurface(surface);
+        return true;
 }
 
 bool apply_missing_texture(SDL_Texture *const texture) {
@@ -5,6 +5,10 @@
 #define MISSING_TEXTURE_WIDTH  64
 #define MISSING_TEXTURE_HEIGHT 64
 
+// Above this simulation time scale, purely presentational work such as entity animations and sounds gets collapsed
+#define FAST_FORWARD_TIME_SCALE 4.0f
+#define UNBOUNDED_TIME_SCALE    10000.0f
+
 typedef struct SDL_Window SDL_Window;
 typedef struct SDL_Renderer SDL_Renderer;
 typedef struct SDL_Texture SDL_Texture;
@@ -15,8 +19,34 @@ SDL_Renderer *get_context_renderer(void);
 
 SDL_Texture *get_mising_texture(void);
 
-bool initialize_context(void);
+bool is_context_headless(void);
+
+bool is_context_vsynced(void);
+
+int get_context_refresh_rate(void);
+
+void set_context_time_scale(const float time_scale);
+
+float get_context_time_scale(void);
+
+bool is_context_fast_forwarding(void);
+
+void request_context_redraw(void);
+
+bool consume_context_redraw(void);
+
+void refresh_context_size(void);
+
+void get_context_window_size(int *const out_width, int *const out_height);
+
+void get_context_drawable_size(int *const out_width, int *const out_height);
+
+bool initialize_context(const bool vsync);
+
+bool initialize_headless_context(const int width, const int height);
 
 void terminate_context(void);
 
-bool apply_missing_texture(SDL_Texture *const texture);
\ No newline at end of file
+bool apply_missing_texture(SDL_Texture *const texture);
+
+bool save_context_frame(const char *const path);
\ No newline at end of file
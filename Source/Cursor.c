@@ -38,6 +38,7 @@ void update_cursor(const double delta_time) {
 #include "Geometry.h"
 #include "Animation.h"
 #include "Context.h"
+#include "Frame.h"
 
 #define TOOLTIP_PADDING 5.0f
 #define TOOLTIP_CURSOR_OFFSET 10.0f
@@ -57,8 +58,12 @@ static bool tooltip_requested_active = false;
 static char *tooltip_string = NULL;
 static struct Text tooltip_text;
 static struct Geometry *tooltip_geometry;
-static float current_tooltip_alpha = 0.0f;
-static float animated_tooltip_alpha = 0.0f;
+static bool outdated_tooltip_geometry = true;
+static float tooltip_geometry_x = 0.0f;
+static float tooltip_geometry_y = 0.0f;
+static float tooltip_geometry_width = 0.0f;
+static float tooltip_geometry_height = 0.0f;
+static uint8_t tooltip_geometry_alpha = 0;
 static struct Animation tooltip_fade;
 
 bool initialize_cursor(void) {
@@ -72,13 +77,14 @@ bool initialize_cursor(void) {
 
         tooltip_geometry = create_geometry();
         initialize_text(&tooltip_text, "[tooltip]", FONT_CAPTION);
-        set_text_color(&tooltip_text, COLOR_WHITE, 0);
+        set_text_color(&tooltip_text, COLOR_YELLOW, 0);
 
         initialize_animation(&tooltip_fade, 2ULL);
+        tooltip_fade.unscaled = true;
 
         struct Action *const fade_in = &tooltip_fade.actions[0];
-        fade_in->type = ACTION_FLOAT;
-        fade_in->target.float_pointer = &animated_tooltip_alpha;
+        fade_in->type = ACTION_TEXT_ALPHA;
+        fade_in->target.text_pointer = &tooltip_text;
         fade_in->keyframes.floats[1] = 1.0f;
         fade_in->easing = QUAD_OUT;
         fade_in->duration = 250.0f;
@@ -86,8 +92,8 @@ bool initialize_cursor(void) {
         fade_in->pause = true;
 
         struct Action *const fade_out = &tooltip_fade.actions[1];
-        fade_out->type = ACTION_FLOAT;
-        fade_out->target.float_pointer = &animated_tooltip_alpha;
+        fade_out->type = ACTION_TEXT_ALPHA;
+        fade_out->target.text_pointer = &tooltip_text;
         fade_out->keyframes.floats[1] = 0.0f;
         fade_out->easing = QUAD_IN;
         fade_out->duration = 100.0f;
@@ -135,11 +141,9 @@ void set_tooltip_text(char *const text) {
 }
 
 void update_cursor(const double delta_time) {
-        update_animation(&tooltip_fade, delta_time);
-
         if (current_cursor != requested_cursor) {
                 current_cursor = requested_cursor;
-                SDL_SetCursor(cursors[current_cursor]);
+                record_frame_cursor(cursors[current_cursor]);
         }
 
         if (tooltip_requested_active && !tooltip_currently_active) {
@@ -152,9 +156,13 @@ void update_cursor(const double delta_time) {
                 restart_animation(&tooltip_fade, 1ULL);
         }
 
-        if (current_tooltip_alpha != animated_tooltip_alpha) {
-                current_tooltip_alpha = animated_tooltip_alpha;
-                set_text_color(&tooltip_text, COLOR_YELLOW, (uint8_t)lroundf(current_tooltip_alpha * 255.0f));
+        // The fade tweens the text's alpha directly, and the background follows whatever the text is at
+        uint8_t tooltip_alpha;
+        get_text_color(&tooltip_text, NULL, NULL, NULL, &tooltip_alpha);
+
+        // Nothing to draw while the tooltip is completely faded out
+        if (tooltip_alpha == 0) {
+                return;
         }
 
         int mouse_x;
@@ -163,11 +171,11 @@ void update_cursor(const double delta_time) {
 
         int window_width;
         int window_height;
-        SDL_GetWindowSize(get_context_window(), &window_width, &window_height);
+        get_context_window_size(&window_width, &window_height);
 
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
 
         const float cursor_x = (float)mouse_x * (float)drawable_width / (float)window_width;
         const float cursor_y = (float)mouse_y * (float)drawable_height / (float)window_height;
@@ -199,16 +207,29 @@ void update_cursor(const double delta_time) {
                 tooltip_center_y = tooltip_height * 0.5f;
         }
 
-        clear_geometry(tooltip_geometry);
-        set_geometry_color(tooltip_geometry, COLOR_BLACK, (uint8_t)lroundf(current_tooltip_alpha * 255.0f * 0.75f));
+        if (outdated_tooltip_geometry || tooltip_geometry_alpha != tooltip_alpha || tooltip_geometry_width != tooltip_width || tooltip_geometry_height != tooltip_height) {
+                clear_geometry(tooltip_geometry);
+                set_geometry_color(tooltip_geometry, COLOR_BLACK, (uint8_t)lroundf((float)tooltip_alpha * 0.75f));
+
+                write_rounded_rectangle_geometry(
+                        tooltip_geometry,
+                        tooltip_center_x, tooltip_center_y,
+                        tooltip_width, tooltip_height,
+                        padding / 4.0f,
+                        0.0f
+                );
+
+                outdated_tooltip_geometry = false;
+                tooltip_geometry_alpha = tooltip_alpha;
+                tooltip_geometry_width = tooltip_width;
+                tooltip_geometry_height = tooltip_height;
+        } else if (tooltip_geometry_x != tooltip_center_x || tooltip_geometry_y != tooltip_center_y) {
+                // The tooltip follows the mouse around, which only needs the rectangle to be moved
+                translate_geometry(tooltip_geometry, tooltip_center_x - tooltip_geometry_x, tooltip_center_y - tooltip_geometry_y);
+        }
 
-        write_rounded_rectangle_geometry(
-                tooltip_geometry,
-                tooltip_center_x, tooltip_center_y,
-                tooltip_width, tooltip_height,
-                padding / 4.0f,
-                0.0f
-        );
+        tooltip_geometry_x = tooltip_center_x;
+        tooltip_geometry_y = tooltip_center_y;
 
         render_geometry(tooltip_geometry);
 
@@ -1,9 +1,128 @@
 #include "Debug.h"
 
+#include <string.h>
+
 #include "SDL.h"
 
+#include "Utilities.h"
+
+// ================================================================================================
+// Frame Times
+// ================================================================================================
+
+// Averages hide hitches, so the interval between every recent pair of presents is kept around for percentiles and the graph,
+// it's written by the render thread and read by the simulation thread
+#define FRAME_HISTORY_CAPACITY 600ULL
+#define DEFAULT_FRAME_BUDGET (1000.0 / 60.0)
+static double frame_history[FRAME_HISTORY_CAPACITY];
+static double sorted_frame_history[FRAME_HISTORY_CAPACITY];
+static size_t frame_history_count = 0ULL;
+static size_t missed_frame_count = 0ULL;
+static SDL_SpinLock frame_history_lock = 0;
+static double frame_budget = DEFAULT_FRAME_BUDGET;
+
+struct FrameTimeStatistics {
+        size_t frame_count;
+        double p50;
+        double p90;
+        double p99;
+        double maximum;
+        size_t missed_count;
+};
+
+void record_debug_frame_interval(const double milliseconds) {
+        SDL_AtomicLock(&frame_history_lock);
+        frame_history[frame_history_count % FRAME_HISTORY_CAPACITY] = milliseconds;
+        ++frame_history_count;
+
+        if (milliseconds > frame_budget) {
+                ++missed_frame_count;
+        }
+        SDL_AtomicUnlock(&frame_history_lock);
+}
+
+void set_debug_frame_budget(const double milliseconds) {
+        frame_budget = milliseconds > 0.0 ? milliseconds : DEFAULT_FRAME_BUDGET;
+}
+
+static int compare_frame_times(const void *const first, const void *const second) {
+        const double first_time = *(const double *)first;
+        const double second_time = *(const double *)second;
+        return (first_time > second_time) - (first_time < second_time);
+}
+
+static inline double get_sorted_frame_percentile(const size_t frame_count, const double percentile) {
+        // Nearest rank, so every reported value is a frame that actually happened
+        const size_t rank = (size_t)ceil(percentile * (double)frame_count);
+        return sorted_frame_history[rank > 0ULL ? rank - 1ULL : 0ULL];
+}
+
+static void compute_frame_time_statistics(struct FrameTimeStatistics *const out_statistics) {
+        SDL_AtomicLock(&frame_history_lock);
+        const size_t frame_count = MINIMUM_VALUE(frame_history_count, FRAME_HISTORY_CAPACITY);
+        memcpy(sorted_frame_history, frame_history, frame_count * sizeof(double));
+        SDL_AtomicUnlock(&frame_history_lock);
+
+        *out_statistics = (struct FrameTimeStatistics){
+                .frame_count = frame_count
+        };
+
+        if (frame_count == 0ULL) {
+                return;
+        }
+
+        qsort(sorted_frame_history, frame_count, sizeof(double), compare_frame_times);
+
+        out_statistics->p50 = get_sorted_frame_percentile(frame_count, 0.50);
+        out_statistics->p90 = get_sorted_frame_percentile(frame_count, 0.90);
+        out_statistics->p99 = get_sorted_frame_percentile(frame_count, 0.99);
+        out_statistics->maximum = sorted_frame_history[frame_count - 1ULL];
+
+        for (size_t frame_index = 0ULL; frame_index < frame_count; ++frame_index) {
+                if (sorted_frame_history[frame_index] > frame_budget) {
+                        ++out_statistics->missed_count;
+                }
+        }
+}
+
+void dump_debug_frame_times(void) {
+        struct FrameTimeStatistics statistics;
+        compute_frame_time_statistics(&statistics);
+
+        SDL_AtomicLock(&frame_history_lock);
+        const size_t missed_count = missed_frame_count;
+        const size_t frame_count = frame_history_count;
+        SDL_AtomicUnlock(&frame_history_lock);
+
+        fprintf(stdout, "dump_debug_frame_times(): %zu of %zu frames missed the %.3lfms budget\n", missed_count, frame_count, frame_budget);
+        fprintf(
+                stdout,
+                "dump_debug_frame_times(): Last %zu frames: p50 %.3lfms, p90 %.3lfms, p99 %.3lfms, max %.3lfms, %zu missed\n",
+                statistics.frame_count,
+                statistics.p50,
+                statistics.p90,
+                statistics.p99,
+                statistics.maximum,
+                statistics.missed_count
+        );
+
+        fflush(stdout);
+}
+
+// ================================================================================================
+// Panel
+// ================================================================================================
+
 #ifdef NDEBUG
 
+void start_debug_frame_profiling(void) {
+        return;
+}
+
+void finish_debug_frame_profiling(void) {
+        return;
+}
+
 void initialize_debug_panel(void) {
         return;
 }
@@ -12,8 +131,8 @@ void terminate_debug_panel(void) {
         return;
 }
 
-void debug_panel_receive_event(const SDL_Event *const event) {
-        return;
+bool debug_panel_receive_event(const SDL_Event *const event) {
+        return false;
 }
 
 void update_debug_panel(const double delta_time) {
@@ -24,11 +143,13 @@ void update_debug_panel(const double delta_time) {
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "Context.h"
 #include "Geometry.h"
 #include "Utilities.h"
 #include "Text.h"
+#include "Profiler.h"
 
 #if defined(PLATFORM_WINDOWS)
 
@@ -117,17 +238,31 @@ static size_t frame_accumulator = 0ULL;
 static size_t displayed_viewport_width = 0ULL;
 static size_t displayed_viewport_height = 0ULL;
 
+#define FRAME_GRAPH_FRAME_COUNT 120ULL
+#define FRAME_GRAPH_TEXT_LINES 3.0f
+
 static struct Geometry *debug_panel_geometry;
+static struct Geometry *debug_graph_geometry;
+static float debug_graph_x = 0.0f;
+static float debug_graph_y = 0.0f;
+static float debug_graph_width = 0.0f;
+static float debug_graph_height = 0.0f;
 
 static struct Text debug_FPS_text;
 static struct Text debug_current_frame_time_text;
 static struct Text debug_average_frame_time_text;
+static struct Text debug_median_frame_time_text;
+static struct Text debug_tail_frame_time_text;
+static struct Text debug_missed_frames_text;
 static struct Text debug_memory_usage_text;
 static struct Text debug_vertex_count_text;
 static struct Text debug_index_count_text;
+static struct Text debug_batch_count_text;
+static struct Text debug_arena_usage_text;
 static struct Text debug_viewport_width_text;
 static struct Text debug_viewport_height_text;
 static struct Text debug_time_elapsed_text;
+static struct Text debug_zone_texts[PROFILE_TOP_ZONE_COUNT];
 
 #define DEBUG_TEXT_BUFFER_SIZE 32
 #define DEBUG_TEXT_COLOR (SDL_Color){255, 255, 255, 255}
@@ -135,12 +270,22 @@ static struct Text *const debug_texts[] = {
         &debug_FPS_text,
         &debug_current_frame_time_text,
         &debug_average_frame_time_text,
+        &debug_median_frame_time_text,
+        &debug_tail_frame_time_text,
+        &debug_missed_frames_text,
         &debug_memory_usage_text,
         &debug_vertex_count_text,
         &debug_index_count_text,
+        &debug_batch_count_text,
+        &debug_arena_usage_text,
         &debug_viewport_width_text,
         &debug_viewport_height_text,
         &debug_time_elapsed_text,
+        &debug_zone_texts[0],
+        &debug_zone_texts[1],
+        &debug_zone_texts[2],
+        &debug_zone_texts[3],
+        &debug_zone_texts[4],
 };
 
 static void resize_debug_panel(void);
@@ -169,6 +314,7 @@ void initialize_debug_panel(void) {
 
         debug_panel_geometry = create_geometry();
         set_geometry_color(debug_panel_geometry, COLOR_BLACK, COLOR_OPAQUE / 2);
+        debug_graph_geometry = create_transient_geometry();
         resize_debug_panel();
 }
 
@@ -176,6 +322,9 @@ void terminate_debug_panel(void) {
         destroy_geometry(debug_panel_geometry);
         debug_panel_geometry = NULL;
 
+        destroy_geometry(debug_graph_geometry);
+        debug_graph_geometry = NULL;
+
         const uint8_t debug_text_count = (uint8_t)(sizeof(debug_texts) / sizeof(debug_texts[0]));
         for (uint8_t debug_text_index = 0; debug_text_index < debug_text_count; ++debug_text_index) {
                 deinitialize_text(debug_texts[debug_text_index]);
@@ -197,6 +346,43 @@ bool debug_panel_receive_event(const SDL_Event *const event) {
 
 static void refresh_debug_panel(void);
 
+static void write_debug_graph_geometry(void) {
+        clear_geometry(debug_graph_geometry);
+
+        // The budget sits at two thirds of the graph's height, and frames that take longer than the whole graph get clipped
+        const float budget_height = debug_graph_height * 2.0f / 3.0f;
+        const float milliseconds_height = budget_height / (float)frame_budget;
+        const float bar_width = debug_graph_width / (float)FRAME_GRAPH_FRAME_COUNT;
+        const float graph_bottom = debug_graph_y + debug_graph_height;
+
+        // The bars are copied out first so that the render thread isn't held up while they get written
+        double graph_frames[FRAME_GRAPH_FRAME_COUNT];
+        SDL_AtomicLock(&frame_history_lock);
+        const size_t bar_count = MINIMUM_VALUE(frame_history_count, FRAME_GRAPH_FRAME_COUNT);
+        const size_t first_frame = frame_history_count - bar_count;
+        for (size_t bar_index = 0ULL; bar_index < bar_count; ++bar_index) {
+                graph_frames[bar_index] = frame_history[(first_frame + bar_index) % FRAME_HISTORY_CAPACITY];
+        }
+        SDL_AtomicUnlock(&frame_history_lock);
+
+        for (size_t bar_index = 0ULL; bar_index < bar_count; ++bar_index) {
+                const double frame_milliseconds = graph_frames[bar_index];
+                const float bar_height = fminf((float)frame_milliseconds * milliseconds_height, debug_graph_height);
+                const float bar_x = debug_graph_x + bar_width * ((float)(FRAME_GRAPH_FRAME_COUNT - bar_count + bar_index) + 0.5f);
+
+                if (frame_milliseconds > frame_budget) {
+                        set_geometry_color(debug_graph_geometry, COLOR_RED, COLOR_OPAQUE);
+                } else {
+                        set_geometry_color(debug_graph_geometry, COLOR_LIGHT_YELLOW, COLOR_OPAQUE);
+                }
+
+                write_rectangle_geometry(debug_graph_geometry, bar_x, graph_bottom - bar_height / 2.0f, bar_width, bar_height, 0.0f);
+        }
+
+        set_geometry_color(debug_graph_geometry, COLOR_WHITE, COLOR_OPAQUE / 2);
+        write_rectangle_geometry(debug_graph_geometry, debug_graph_x + debug_graph_width / 2.0f, graph_bottom - budget_height, debug_graph_width, 1.0f, 0.0f);
+}
+
 void update_debug_panel(const double delta_time) {
         actual_time_elapsed += delta_time;
         actual_time_accumulator += delta_time;
@@ -210,6 +396,9 @@ void update_debug_panel(const double delta_time) {
 
         render_geometry(debug_panel_geometry);
 
+        write_debug_graph_geometry();
+        render_geometry(debug_graph_geometry);
+
         const uint8_t debug_text_count = (uint8_t)(sizeof(debug_texts) / sizeof(debug_texts[0]));
         for (uint8_t debug_text_index = 0; debug_text_index < debug_text_count; ++debug_text_index) {
                 update_text(debug_texts[debug_text_index]);
@@ -233,11 +422,12 @@ static void resize_debug_panel(void) {
 
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
         const float padding = CLAMP_VALUE(MAXIMUM_VALUE((float)drawable_width, (float)drawable_height) / 100.0f, 10.0f, 20.0f);
 
         const float debug_panel_width = (float)debug_text_width + padding * 2.0f;
-        const float debug_panel_height = (float)debug_text_height * (float)debug_text_count + padding * 2.0f;
+        const float debug_graph_space = (float)debug_text_height * FRAME_GRAPH_TEXT_LINES;
+        const float debug_panel_height = (float)debug_text_height * (float)debug_text_count + debug_graph_space + padding * 3.0f;
 
         const float debug_panel_x =                           padding + debug_panel_width  / 2.0f;
         const float debug_panel_y = (float)drawable_height - (padding + debug_panel_height / 2.0f);
@@ -251,6 +441,12 @@ static void resize_debug_panel(void) {
                 0.0f
         );
 
+        // The graph sits at the top of the panel, above the texts that are stacked up from its bottom
+        debug_graph_x = padding * 2.0f;
+        debug_graph_y = debug_panel_y - debug_panel_height / 2.0f + padding;
+        debug_graph_width = (float)debug_text_width;
+        debug_graph_height = debug_graph_space;
+
         for (uint8_t debug_text_index = 0; debug_text_index < debug_text_count; ++debug_text_index) {
                 const uint8_t reversed_index = debug_text_count - debug_text_index - 1;
                 debug_texts[debug_text_index]->absolute_offset_x = padding * 2.0f;
@@ -271,6 +467,18 @@ static void refresh_debug_panel(void) {
         snprintf(debug_text_buffer, debug_text_buffer_size, "Average:  %.3lfms", time_accumulator * 1000.0 / (double)frame_accumulator);
         set_text_string(&debug_average_frame_time_text, debug_text_buffer);
 
+        struct FrameTimeStatistics statistics;
+        compute_frame_time_statistics(&statistics);
+
+        snprintf(debug_text_buffer, debug_text_buffer_size, "P50/P90:  %.2lf/%.2lfms", statistics.p50, statistics.p90);
+        set_text_string(&debug_median_frame_time_text, debug_text_buffer);
+
+        snprintf(debug_text_buffer, debug_text_buffer_size, "P99/Max:  %.2lf/%.2lfms", statistics.p99, statistics.maximum);
+        set_text_string(&debug_tail_frame_time_text, debug_text_buffer);
+
+        snprintf(debug_text_buffer, debug_text_buffer_size, "Missed:   %zu/%zu", statistics.missed_count, statistics.frame_count);
+        set_text_string(&debug_missed_frames_text, debug_text_buffer);
+
         size_t memory_usage_bytes;
         if (get_process_memory_usage_bytes(&memory_usage_bytes)) {
                 snprintf(debug_text_buffer, debug_text_buffer_size, "Memory:   %.1lfMB", (double)memory_usage_bytes / (1024.0 * 1024.0));
@@ -281,7 +489,8 @@ static void refresh_debug_panel(void) {
 
         size_t vertex_count;
         size_t index_count;
-        get_tracked_geometry_data(&vertex_count, &index_count);
+        size_t batch_count;
+        get_tracked_geometry_data(&vertex_count, &index_count, &batch_count);
 
         snprintf(debug_text_buffer, debug_text_buffer_size, "Vertices: %zu", vertex_count);
         set_text_string(&debug_vertex_count_text, debug_text_buffer);
@@ -289,9 +498,18 @@ static void refresh_debug_panel(void) {
         snprintf(debug_text_buffer, debug_text_buffer_size, "Indices:  %zu", index_count);
         set_text_string(&debug_index_count_text, debug_text_buffer);
 
+        snprintf(debug_text_buffer, debug_text_buffer_size, "Batches:  %zu", batch_count);
+        set_text_string(&debug_batch_count_text, debug_text_buffer);
+
+        size_t arena_frame_bytes;
+        size_t arena_peak_bytes;
+        get_geometry_arena_data(&arena_frame_bytes, &arena_peak_bytes, NULL);
+        snprintf(debug_text_buffer, debug_text_buffer_size, "Arena:    %.1lf/%.1lfKB", (double)arena_frame_bytes / 1024.0, (double)arena_peak_bytes / 1024.0);
+        set_text_string(&debug_arena_usage_text, debug_text_buffer);
+
         int window_width;
         int window_height;
-        SDL_GetWindowSizeInPixels(get_context_window(), &window_width, &window_height);
+        get_context_drawable_size(&window_width, &window_height);
 
         if (displayed_viewport_width != (size_t)window_width || displayed_viewport_height != (size_t)window_height) {
                 displayed_viewport_width  = (size_t)window_width;
@@ -308,6 +526,19 @@ static void refresh_debug_panel(void) {
         snprintf(debug_text_buffer, debug_text_buffer_size, "Time:     %.3lfsec", actual_time_elapsed / 100);
         set_text_string(&debug_time_elapsed_text, debug_text_buffer);
 
+        // The most expensive zones of the refresh interval, in milliseconds per frame summed over every thread
+        struct ProfileZoneSummary zone_summaries[PROFILE_TOP_ZONE_COUNT];
+        const size_t zone_summary_count = summarize_profile_zones(zone_summaries, PROFILE_TOP_ZONE_COUNT);
+        for (size_t zone_index = 0ULL; zone_index < PROFILE_TOP_ZONE_COUNT; ++zone_index) {
+                if (zone_index < zone_summary_count) {
+                        snprintf(debug_text_buffer, debug_text_buffer_size, "%-20.20s%.3lfms", zone_summaries[zone_index].name, zone_summaries[zone_index].milliseconds_per_frame);
+                } else {
+                        snprintf(debug_text_buffer, debug_text_buffer_size, "%-20.20s-", "");
+                }
+
+                set_text_string(&debug_zone_texts[zone_index], debug_text_buffer);
+        }
+
         time_accumulator = 0.0f;
         frame_accumulator = 0ULL;
         resize_debug_panel();
@@ -8,6 +8,9 @@
 
 void start_debug_frame_profiling(void);
 void finish_debug_frame_profiling(void);
+void record_debug_frame_interval(const double milliseconds);
+void set_debug_frame_budget(const double milliseconds);
+void dump_debug_frame_times(void);
 
 void initialize_debug_panel(void);
 void terminate_debug_panel(void);
@@ -10,11 +10,26 @@
 #include "Hexagons.h"
 #include "Animation.h"
 #include "Audio.h"
+#include "Context.h"
+#include "Jobs.h"
+
+// Everything the tessellation job draws from, copied out of the entity before the job is submitted. Animations and resizes
+// keep writing to the entity itself while the job runs, so the job never reads live entity state.
+struct EntitySnapshot {
+        SDL_FPoint position;
+        float angle;
+        float radius;
+        float wings_angle;
+        SDL_FPoint antenna_offset;
+        float float_time;
+};
 
 struct Entity {
         struct Level *level;
         enum EntityType type;
         struct Geometry *geometry;
+        struct JobBatch tessellation;
+        struct EntitySnapshot snapshot;
         uint16_t last_tile_index;
         uint16_t next_tile_index;
         enum Orientation last_orientation;
@@ -48,14 +63,24 @@ struct Entity {
 #define PULSE_ENTITY_SCALE(entity, scale)                                   \
         do {                                                                \
                 (entity)->scaling.actions[0].keyframes.floats[1] = (scale); \
-                restart_animation(&(entity)->scaling, 0ULL);                \
+                reset_animation(&(entity)->scaling);                        \
+                play_entity_animation(&(entity)->scaling);                  \
         } while (0);                                                        \
 
+// Fast-forwarded playback jumps every animation straight to its end, so that the level is ready for the next change right away
+static void play_entity_animation(struct Animation *const animation) {
+        start_animation(animation, 0ULL);
+        if (is_context_fast_forwarding()) {
+                finish_animation(animation);
+        }
+}
+
 struct Entity *create_entity(struct Level *const level, const enum EntityType type, const uint16_t tile_index, const enum Orientation orientation) {
         struct Entity *const entity = (struct Entity *)xmalloc(sizeof(struct Entity));
         entity->type = type;
         entity->level = level;
-        entity->geometry = create_geometry();
+        entity->geometry = create_transient_geometry();
+        SDL_AtomicSet(&entity->tessellation.remaining_jobs, 0);
         entity->last_tile_index = tile_index;
         entity->next_tile_index = tile_index;
         entity->last_orientation = orientation;
@@ -166,6 +191,8 @@ void destroy_entity(struct Entity *const entity) {
                 return;
         }
 
+        wait_for_job_batch(&entity->tessellation);
+
         if (entity->type == ENTITY_PLAYER) {
                 struct Player *const player = &entity->as.player;
                 deinitialize_animation(&player->flapping);
@@ -180,30 +207,22 @@ void destroy_entity(struct Entity *const entity) {
         xfree(entity);
 }
 
-void update_entity(struct Entity *const entity, const double delta_time) {
-        update_animation(&entity->moving, delta_time);
-        update_animation(&entity->turning, delta_time);
-        update_animation(&entity->scaling, delta_time);
-        update_animation(&entity->recoiling, delta_time);
-
-        const float radius = entity->radius * entity->scale;
+// Runs as a job, so it only reads the entity's snapshot and writes into its own geometry
+static void write_entity_geometry(void *const data) {
+        struct Entity *const entity = (struct Entity *)data;
+        const struct EntitySnapshot *const snapshot = &entity->snapshot;
+        const float radius = snapshot->radius;
 
         if (entity->type == ENTITY_PLAYER) {
-                struct Player *const player = &entity->as.player;
-
-                update_animation(&player->flapping, delta_time);
-                update_animation(&player->bouncing, delta_time);
+                float x = snapshot->position.x;
+                float y = snapshot->position.y;
 
-                float x = entity->position.x;
-                float y = entity->position.y;
-
-                player->float_time += delta_time / 500.0f;
-                const float float_x = cosf(player->float_time) / 5.0f;
-                const float float_y = sinf(player->float_time) / 5.0f;
+                const float float_x = cosf(snapshot->float_time) / 5.0f;
+                const float float_y = sinf(snapshot->float_time) / 5.0f;
                 const float float_angle = (float_x + float_y) / 2.5f;
 
-                const float wings_angle = player->wings_angle + float_angle;
-                const float rotation = entity->angle + float_angle;
+                const float wings_angle = snapshot->wings_angle + float_angle;
+                const float rotation = snapshot->angle + float_angle;
 
                 x += float_x * radius / 5.0f;
                 y += float_y * radius / 5.0f;
@@ -255,14 +274,14 @@ void update_entity(struct Entity *const entity, const double delta_time) {
                         (SDL_FPoint){right_antenna_tip_position.x - line_width * 0.0f, right_antenna_tip_position.y - body_thickness / 2.5f}
                 };
 
-                left_antenna_endpoints[1].x       += radius * player->antenna_offset.x;
-                left_antenna_endpoints[1].y       += radius * player->antenna_offset.y;
-                right_antenna_endpoints[1].x      += radius * player->antenna_offset.x;
-                right_antenna_endpoints[1].y      += radius * player->antenna_offset.y;
-                left_antenna_control_points[1].x  += radius * player->antenna_offset.x / 2.0f;
-                left_antenna_control_points[1].y  += radius * player->antenna_offset.y / 2.0f;
-                right_antenna_control_points[1].x += radius * player->antenna_offset.x / 2.0f;
-                right_antenna_control_points[1].y += radius * player->antenna_offset.y / 2.0f;
+                left_antenna_endpoints[1].x       += radius * snapshot->antenna_offset.x;
+                left_antenna_endpoints[1].y       += radius * snapshot->antenna_offset.y;
+                right_antenna_endpoints[1].x      += radius * snapshot->antenna_offset.x;
+                right_antenna_endpoints[1].y      += radius * snapshot->antenna_offset.y;
+                left_antenna_control_points[1].x  += radius * snapshot->antenna_offset.x / 2.0f;
+                left_antenna_control_points[1].y  += radius * snapshot->antenna_offset.y / 2.0f;
+                right_antenna_control_points[1].x += radius * snapshot->antenna_offset.x / 2.0f;
+                right_antenna_control_points[1].y += radius * snapshot->antenna_offset.y / 2.0f;
 
                 SDL_FPoint stinger[] = {
                         (SDL_FPoint){x - body_length / 2.0f,                      y + line_width * 1.5f},
@@ -370,14 +389,12 @@ void update_entity(struct Entity *const entity, const double delta_time) {
 
                 set_geometry_color(entity->geometry, COLOR_LIGHT_YELLOW, COLOR_OPAQUE);
                 write_ellipse_geometry(entity->geometry, right_wing_center.x, right_wing_center.y, wings_filled_radii.x, wings_filled_radii.y, -rotation + right_wing_angle);
-
-                render_geometry(entity->geometry);
         }
 
         if (entity->type == ENTITY_BLOCK) {
                 const float thickness = radius / 5.0f;
-                const float x = entity->position.x;
-                const float y = entity->position.y - thickness / 2.0f;
+                const float x = snapshot->position.x;
+                const float y = snapshot->position.y - thickness / 2.0f;
 
                 clear_geometry(entity->geometry);
 
@@ -386,9 +403,35 @@ void update_entity(struct Entity *const entity, const double delta_time) {
 
                 set_geometry_color(entity->geometry, COLOR_LIGHT_YELLOW, COLOR_OPAQUE);
                 write_hexagon_geometry(entity->geometry, x, y, radius / 2.0f, 0.0f);
+        }
+}
 
-                render_geometry(entity->geometry);
+void update_entity(struct Entity *const entity, const double delta_time) {
+        if (entity->type == ENTITY_PLAYER) {
+                // The player never stops floating, which keeps frames coming while a level is on screen
+                entity->as.player.float_time += delta_time / 500.0f;
+                request_context_redraw();
         }
+
+        // The snapshot can only be rewritten once the previous tessellation is done reading it
+        wait_for_job_batch(&entity->tessellation);
+
+        struct EntitySnapshot *const snapshot = &entity->snapshot;
+        snapshot->position = entity->position;
+        snapshot->angle = entity->angle;
+        snapshot->radius = entity->radius * entity->scale;
+        if (entity->type == ENTITY_PLAYER) {
+                snapshot->wings_angle = entity->as.player.wings_angle;
+                snapshot->antenna_offset = entity->as.player.antenna_offset;
+                snapshot->float_time = entity->as.player.float_time;
+        }
+
+        submit_job(&entity->tessellation, "write_entity_geometry", write_entity_geometry, entity);
+}
+
+void render_entity(struct Entity *const entity) {
+        wait_for_job_batch(&entity->tessellation);
+        render_geometry(entity->geometry);
 }
 
 void resize_entity(struct Entity *const entity, const float radius) {
@@ -426,7 +469,7 @@ void entity_handle_change(struct Entity *const entity, const struct Change *cons
                 entity->next_orientation = change->turn.next_orientation;
 
                 entity->turning.actions[0].keyframes.floats[1] = (change->input == INPUT_RIGHT ? -1.0f : 1.0f) * (float)M_PI * 2.0f / 6.0f;
-                start_animation(&entity->turning, 0ULL);
+                play_entity_animation(&entity->turning);
                 PULSE_ENTITY_SCALE(entity, 1.1f);
 
                 if (entity->type == ENTITY_PLAYER) {
@@ -435,7 +478,7 @@ void entity_handle_change(struct Entity *const entity, const struct Change *cons
                         struct Action *const bounce_away = &player->bouncing.actions[0];
                         bounce_away->keyframes.points[1].x = 0.125f;
                         bounce_away->keyframes.points[1].y = change->input == INPUT_RIGHT ? 0.125f : -0.125f;
-                        start_animation(&player->bouncing, 0ULL);
+                        play_entity_animation(&player->bouncing);
                 }
 
                 return;
@@ -455,17 +498,17 @@ void entity_handle_change(struct Entity *const entity, const struct Change *cons
                 move_back->keyframes.points[1].x = x;
                 move_back->keyframes.points[1].y = y;
 
-                start_animation(&entity->recoiling, 0ULL);
+                play_entity_animation(&entity->recoiling);
                 PULSE_ENTITY_SCALE(entity, 1.1f);
 
                 if (entity->type == ENTITY_PLAYER) {
                         struct Player *const player = &entity->as.player;
-                        start_animation(&player->flapping, 0ULL);
+                        play_entity_animation(&player->flapping);
 
                         struct Action *const bounce_away = &player->bouncing.actions[0];
                         bounce_away->keyframes.points[1].x = change->input == INPUT_FORWARD ? -0.125f : 0.125f;
                         bounce_away->keyframes.points[1].y = 0.0f;
-                        start_animation(&player->bouncing, 0ULL);
+                        play_entity_animation(&player->bouncing);
                 }
 
                 return;
@@ -498,16 +541,16 @@ void entity_handle_change(struct Entity *const entity, const struct Change *cons
                 }
         }
 
-        start_animation(&entity->moving, 0ULL);
+        play_entity_animation(&entity->moving);
         PULSE_ENTITY_SCALE(entity, 1.2f);
 
         if (entity->type == ENTITY_PLAYER) {
                 struct Player *const player = &entity->as.player;
-                start_animation(&player->flapping, 0ULL);
+                play_entity_animation(&player->flapping);
 
                 struct Action *const bounce_away = &player->bouncing.actions[0];
                 bounce_away->keyframes.points[1].x = change->input == INPUT_FORWARD ? -0.25f : 0.25f;
                 bounce_away->keyframes.points[1].y = 0.0f;
-                start_animation(&player->bouncing, 0ULL);
+                play_entity_animation(&player->bouncing);
         }
 }
\ No newline at end of file
@@ -21,6 +21,7 @@ struct Entity *create_entity(struct Level *const level, const enum EntityType ty
 void destroy_entity(struct Entity *const entity);
 
 void update_entity(struct Entity *const entity, const double delta_time);
+void render_entity(struct Entity *const entity);
 void resize_entity(struct Entity *const entity, const float radius);
 
 enum EntityType get_entity_type(const struct Entity *const entity);
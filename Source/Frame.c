@@ -0,0 +1,736 @@
+#include "Frame.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "SDL.h"
+
+#include "Context.h"
+#include "Utilities.h"
+
+#define FRAME_PACKET_COUNT   2ULL
+#define FRAME_EVENT_CAPACITY 256ULL
+
+// ================================================================================================
+// Packets
+// ================================================================================================
+
+enum FrameCommandType {
+        FRAME_COMMAND_CLEAR,
+        FRAME_COMMAND_GEOMETRY,
+        FRAME_COMMAND_TEXTURED_GEOMETRY,
+        FRAME_COMMAND_COPY,
+        FRAME_COMMAND_RENDER_TARGET,
+        FRAME_COMMAND_CURSOR,
+        FRAME_COMMAND_TEXTURE_UPDATE
+};
+
+struct FrameCommand {
+        enum FrameCommandType type;
+        SDL_Texture *texture;
+        SDL_Cursor *cursor;
+        size_t first_vertex;
+        size_t vertex_count;
+        size_t first_index;
+        size_t index_count;
+        size_t first_pixel;
+        int pitch;
+        SDL_Rect rectangle;
+        double angle;
+        SDL_Color color;
+};
+
+// Everything the simulation wants drawn for one frame, recorded in order and only handed to SDL by the render thread. The
+// packets are grown by the simulation alone, the render thread only reads them, so neither of them allocates behind the other.
+struct FramePacket {
+        struct FrameCommand *commands;
+        size_t command_count;
+        size_t command_capacity;
+        float *positions;
+        uint8_t *colors;
+        size_t vertex_count;
+        size_t vertex_capacity;
+        uint32_t *indices;
+        size_t index_count;
+        size_t index_capacity;
+        SDL_Vertex *textured_vertices;
+        size_t textured_vertex_count;
+        size_t textured_vertex_capacity;
+        int *textured_indices;
+        size_t textured_index_count;
+        size_t textured_index_capacity;
+        uint8_t *pixels;
+        size_t pixel_count;
+        size_t pixel_capacity;
+        SDL_Texture **released_textures;
+        size_t released_texture_count;
+        size_t released_texture_capacity;
+        bool idle;
+};
+
+static struct FramePacket frame_packets[FRAME_PACKET_COUNT];
+static size_t building_packet_index = 0ULL;
+static bool recording = false;
+
+// What the recorded draws currently land on, so that culling and render targets behave as if they were drawn right away
+static SDL_Texture *recorded_render_target = NULL;
+static int recorded_viewport_width = 0;
+static int recorded_viewport_height = 0;
+
+static void secure_packet_capacity(void **const array, size_t *const capacity, const size_t required_capacity, const size_t element_size) {
+        if (required_capacity <= *capacity) {
+                return;
+        }
+
+        size_t new_capacity = *capacity ? *capacity : 64ULL;
+        while (new_capacity < required_capacity) {
+                new_capacity *= 2ULL;
+        }
+
+        *array = xrealloc(*array, element_size * new_capacity);
+        *capacity = new_capacity;
+}
+
+static struct FrameCommand *push_frame_command(const enum FrameCommandType type) {
+        struct FramePacket *const packet = &frame_packets[building_packet_index];
+        secure_packet_capacity((void **)&packet->commands, &packet->command_capacity, packet->command_count + 1ULL, sizeof(struct FrameCommand));
+
+        struct FrameCommand *const command = &packet->commands[packet->command_count++];
+        memset(command, 0, sizeof(struct FrameCommand));
+        command->type = type;
+        return command;
+}
+
+static void begin_frame_packet(void) {
+        struct FramePacket *const packet = &frame_packets[building_packet_index];
+        packet->command_count = 0ULL;
+        packet->vertex_count = 0ULL;
+        packet->index_count = 0ULL;
+        packet->textured_vertex_count = 0ULL;
+        packet->textured_index_count = 0ULL;
+        packet->pixel_count = 0ULL;
+        packet->idle = false;
+
+        recorded_render_target = NULL;
+        get_context_drawable_size(&recorded_viewport_width, &recorded_viewport_height);
+        recording = true;
+}
+
+static void replay_frame_packet(struct FramePacket *const packet) {
+        SDL_Renderer *const renderer = get_context_renderer();
+
+        for (size_t command_index = 0ULL; command_index < packet->command_count; ++command_index) {
+                const struct FrameCommand *const command = &packet->commands[command_index];
+                switch (command->type) {
+                        case FRAME_COMMAND_CLEAR: {
+                                SDL_SetRenderDrawColor(renderer, command->color.r, command->color.g, command->color.b, command->color.a);
+                                SDL_RenderClear(renderer);
+                                break;
+                        }
+
+                        case FRAME_COMMAND_GEOMETRY: {
+                                SDL_RenderGeometryRaw(
+                                        renderer,
+                                        NULL,
+                                        packet->positions + command->first_vertex * 2ULL,
+                                        (int)(sizeof(float) * 2ULL),
+                                        (SDL_Color *)(packet->colors + command->first_vertex * 4ULL),
+                                        (int)(sizeof(uint8_t) * 4ULL),
+                                        NULL,
+                                        0,
+                                        (int)command->vertex_count,
+                                        packet->indices + command->first_index,
+                                        (int)command->index_count,
+                                        (int)sizeof(uint32_t)
+                                );
+
+                                break;
+                        }
+
+                        case FRAME_COMMAND_TEXTURED_GEOMETRY: {
+                                SDL_RenderGeometry(
+                                        renderer, command->texture,
+                                        packet->textured_vertices + command->first_vertex, (int)command->vertex_count,
+                                        packet->textured_indices + command->first_index, (int)command->index_count
+                                );
+
+                                break;
+                        }
+
+                        case FRAME_COMMAND_COPY: {
+                                SDL_RenderCopyEx(renderer, command->texture, NULL, &command->rectangle, command->angle, NULL, SDL_FLIP_NONE);
+                                break;
+                        }
+
+                        case FRAME_COMMAND_RENDER_TARGET: {
+                                SDL_SetRenderTarget(renderer, command->texture);
+                                break;
+                        }
+
+                        case FRAME_COMMAND_CURSOR: {
+                                SDL_SetCursor(command->cursor);
+                                break;
+                        }
+
+                        case FRAME_COMMAND_TEXTURE_UPDATE: {
+                                SDL_UpdateTexture(command->texture, &command->rectangle, packet->pixels + command->first_pixel, command->pitch);
+                                break;
+                        }
+                }
+        }
+
+        // Textures released while this packet was built may still have been drawn by it or by the packet before it
+        for (size_t texture_index = 0ULL; texture_index < packet->released_texture_count; ++texture_index) {
+                SDL_DestroyTexture(packet->released_textures[texture_index]);
+        }
+
+        packet->released_texture_count = 0ULL;
+}
+
+static void destroy_frame_packets(void) {
+        for (size_t packet_index = 0ULL; packet_index < FRAME_PACKET_COUNT; ++packet_index) {
+                struct FramePacket *const packet = &frame_packets[packet_index];
+                for (size_t texture_index = 0ULL; texture_index < packet->released_texture_count; ++texture_index) {
+                        SDL_DestroyTexture(packet->released_textures[texture_index]);
+                }
+
+                if (packet->commands) {
+                        xfree(packet->commands);
+                }
+
+                if (packet->positions) {
+                        xfree(packet->positions);
+                        xfree(packet->colors);
+                }
+
+                if (packet->indices) {
+                        xfree(packet->indices);
+                }
+
+                if (packet->textured_vertices) {
+                        xfree(packet->textured_vertices);
+                }
+
+                if (packet->textured_indices) {
+                        xfree(packet->textured_indices);
+                }
+
+                if (packet->pixels) {
+                        xfree(packet->pixels);
+                }
+
+                if (packet->released_textures) {
+                        xfree(packet->released_textures);
+                }
+
+                *packet = (struct FramePacket){ 0 };
+        }
+}
+
+// ================================================================================================
+// Recording
+// ================================================================================================
+
+void get_frame_viewport_size(int *const out_width, int *const out_height) {
+        if (!recording) {
+                get_context_drawable_size(out_width, out_height);
+                return;
+        }
+
+        if (out_width != NULL) {
+                *out_width = recorded_viewport_width;
+        }
+
+        if (out_height != NULL) {
+                *out_height = recorded_viewport_height;
+        }
+}
+
+void record_frame_clear(const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a) {
+        struct FrameCommand *const command = push_frame_command(FRAME_COMMAND_CLEAR);
+        command->color = (SDL_Color){ .r = r, .g = g, .b = b, .a = a };
+}
+
+void record_frame_geometry(
+        const float *const positions,
+        const uint8_t *const colors,
+        const size_t vertex_count,
+        const uint32_t *const indices,
+        const size_t index_count
+) {
+        if (!vertex_count || !index_count) {
+                return;
+        }
+
+        struct FramePacket *const packet = &frame_packets[building_packet_index];
+
+        // Positions and colors always grow together, so they share the vertex capacity
+        const size_t vertex_capacity = packet->vertex_capacity;
+        secure_packet_capacity((void **)&packet->positions, &packet->vertex_capacity, packet->vertex_count + vertex_count, sizeof(float) * 2ULL);
+        if (packet->vertex_capacity != vertex_capacity) {
+                packet->colors = (uint8_t *)xrealloc(packet->colors, sizeof(uint8_t) * 4ULL * packet->vertex_capacity);
+        }
+
+        secure_packet_capacity((void **)&packet->indices, &packet->index_capacity, packet->index_count + index_count, sizeof(uint32_t));
+
+        memcpy(packet->positions + packet->vertex_count * 2ULL, positions, sizeof(float) * 2ULL * vertex_count);
+        memcpy(packet->colors + packet->vertex_count * 4ULL, colors, sizeof(uint8_t) * 4ULL * vertex_count);
+        memcpy(packet->indices + packet->index_count, indices, sizeof(uint32_t) * index_count);
+
+        struct FrameCommand *const command = push_frame_command(FRAME_COMMAND_GEOMETRY);
+        command->first_vertex = packet->vertex_count;
+        command->vertex_count = vertex_count;
+        command->first_index = packet->index_count;
+        command->index_count = index_count;
+
+        packet->vertex_count += vertex_count;
+        packet->index_count += index_count;
+}
+
+void record_frame_textured_geometry(
+        SDL_Texture *const texture,
+        const SDL_Vertex *const vertices,
+        const size_t vertex_count,
+        const int *const indices,
+        const size_t index_count
+) {
+        if (!vertex_count || !index_count) {
+                return;
+        }
+
+        struct FramePacket *const packet = &frame_packets[building_packet_index];
+        secure_packet_capacity((void **)&packet->textured_vertices, &packet->textured_vertex_capacity, packet->textured_vertex_count + vertex_count, sizeof(SDL_Vertex));
+        secure_packet_capacity((void **)&packet->textured_indices, &packet->textured_index_capacity, packet->textured_index_count + index_count, sizeof(int));
+
+        memcpy(packet->textured_vertices + packet->textured_vertex_count, vertices, sizeof(SDL_Vertex) * vertex_count);
+        memcpy(packet->textured_indices + packet->textured_index_count, indices, sizeof(int) * index_count);
+
+        struct FrameCommand *const command = push_frame_command(FRAME_COMMAND_TEXTURED_GEOMETRY);
+        command->texture = texture;
+        command->first_vertex = packet->textured_vertex_count;
+        command->vertex_count = vertex_count;
+        command->first_index = packet->textured_index_count;
+        command->index_count = index_count;
+
+        packet->textured_vertex_count += vertex_count;
+        packet->textured_index_count += index_count;
+}
+
+void record_frame_copy(SDL_Texture *const texture, const SDL_Rect *const destination, const double angle) {
+        struct FrameCommand *const command = push_frame_command(FRAME_COMMAND_COPY);
+        command->texture = texture;
+        command->rectangle = *destination;
+        command->angle = angle;
+}
+
+void record_frame_render_target(SDL_Texture *const texture) {
+        struct FrameCommand *const command = push_frame_command(FRAME_COMMAND_RENDER_TARGET);
+        command->texture = texture;
+
+        recorded_render_target = texture;
+        if (!texture || SDL_QueryTexture(texture, NULL, NULL, &recorded_viewport_width, &recorded_viewport_height) < 0) {
+                get_context_drawable_size(&recorded_viewport_width, &recorded_viewport_height);
+        }
+}
+
+SDL_Texture *get_frame_render_target(void) {
+        return recorded_render_target;
+}
+
+// Cursors belong to the thread that owns the window, so they're switched when the frame is replayed
+void record_frame_cursor(SDL_Cursor *const cursor) {
+        if (!recording) {
+                SDL_SetCursor(cursor);
+                return;
+        }
+
+        struct FrameCommand *const command = push_frame_command(FRAME_COMMAND_CURSOR);
+        command->cursor = cursor;
+}
+
+// ================================================================================================
+// Pipeline
+// ================================================================================================
+
+// The simulation builds frame N + 1 on its own thread while the render thread (the one that created the renderer) replays
+// frame N and presents it. Anything that has to reach the renderer should be recorded into the packet, run_frame_task() blocks
+// its caller until the render thread is done presenting and is only meant for rare work such as creating textures.
+static bool (*frame_builder)(const double delta_time) = NULL;
+static SDL_threadID render_thread_id = 0;
+static SDL_Thread *simulation_thread = NULL;
+static SDL_mutex *pipeline_mutex = NULL;
+static SDL_cond *simulation_condition = NULL;
+static SDL_cond *render_condition = NULL;
+static SDL_cond *task_condition = NULL;
+static bool simulation_requested = false;
+static bool simulation_building = false;
+static bool simulation_quitting = false;
+static double requested_delta_time = 0.0;
+static bool pipeline_primed = false;
+
+// Queued on the stacks of the threads waiting for them, so that any number of threads can hand tasks over at once
+struct FrameTask {
+        void (*function)(void *);
+        void *data;
+        bool done;
+        struct FrameTask *next;
+};
+
+static struct FrameTask *first_pending_task = NULL;
+static struct FrameTask *last_pending_task = NULL;
+
+// Events are gathered by the render thread and handed over as a whole when the next frame starts building
+static SDL_Event gathered_events[FRAME_EVENT_CAPACITY];
+static size_t gathered_event_count = 0ULL;
+static SDL_Event frame_events[FRAME_EVENT_CAPACITY];
+static size_t frame_event_count = 0ULL;
+static size_t frame_event_index = 0ULL;
+static bool events_in_flight = false;
+
+static void build_frame_packet(const double delta_time) {
+        begin_frame_packet();
+        const bool idle = frame_builder(delta_time);
+        recording = false;
+        frame_packets[building_packet_index].idle = idle;
+}
+
+static void hand_frame_events(void) {
+        memcpy(frame_events, gathered_events, sizeof(SDL_Event) * gathered_event_count);
+        frame_event_count = gathered_event_count;
+        frame_event_index = 0ULL;
+        events_in_flight = gathered_event_count != 0ULL;
+        gathered_event_count = 0ULL;
+}
+
+static int run_simulation_thread(void *const data) {
+        SDL_LockMutex(pipeline_mutex);
+        while (true) {
+                while (!simulation_requested && !simulation_quitting) {
+                        SDL_CondWait(simulation_condition, pipeline_mutex);
+                }
+
+                if (simulation_quitting) {
+                        break;
+                }
+
+                simulation_requested = false;
+                const double delta_time = requested_delta_time;
+                SDL_UnlockMutex(pipeline_mutex);
+
+                build_frame_packet(delta_time);
+
+                SDL_LockMutex(pipeline_mutex);
+                simulation_building = false;
+                SDL_CondSignal(render_condition);
+        }
+
+        SDL_UnlockMutex(pipeline_mutex);
+        return 0;
+}
+
+// Expects the pipeline mutex to be locked, runs the tasks the other threads ask for while it waits
+static void wait_for_frame_build(void) {
+        while (simulation_building || first_pending_task) {
+                if (first_pending_task) {
+                        struct FrameTask *const task = first_pending_task;
+                        if (!(first_pending_task = task->next)) {
+                                last_pending_task = NULL;
+                        }
+
+                        SDL_UnlockMutex(pipeline_mutex);
+                        task->function(task->data);
+                        SDL_LockMutex(pipeline_mutex);
+
+                        task->done = true;
+                        SDL_CondBroadcast(task_condition);
+                        continue;
+                }
+
+                SDL_CondWait(render_condition, pipeline_mutex);
+        }
+}
+
+static void request_frame_build(const double delta_time) {
+        hand_frame_events();
+        refresh_context_size();
+        requested_delta_time = delta_time;
+        simulation_requested = true;
+        simulation_building = true;
+        SDL_CondSignal(simulation_condition);
+}
+
+static void destroy_pipeline_primitives(void) {
+        if (task_condition) {
+                SDL_DestroyCond(task_condition);
+                task_condition = NULL;
+        }
+
+        if (render_condition) {
+                SDL_DestroyCond(render_condition);
+                render_condition = NULL;
+        }
+
+        if (simulation_condition) {
+                SDL_DestroyCond(simulation_condition);
+                simulation_condition = NULL;
+        }
+
+        if (pipeline_mutex) {
+                SDL_DestroyMutex(pipeline_mutex);
+                pipeline_mutex = NULL;
+        }
+}
+
+// Frames are built and replayed one after the other on the calling thread when there's no simulation thread, which is also
+// what a failure to start one falls back to
+void initialize_frame_pipeline(bool (*const build_frame)(const double delta_time), const bool threaded) {
+        frame_builder = build_frame;
+        render_thread_id = SDL_ThreadID();
+        building_packet_index = 0ULL;
+        pipeline_primed = false;
+
+        if (!threaded) {
+                return;
+        }
+
+        if (!(pipeline_mutex = SDL_CreateMutex())) {
+                send_message(MESSAGE_ERROR, "Failed to start simulation thread: Failed to create mutex: %s", SDL_GetMESSAGE_ERROR());
+                return;
+        }
+
+        if (!(simulation_condition = SDL_CreateCond()) || !(render_condition = SDL_CreateCond()) || !(task_condition = SDL_CreateCond())) {
+                send_message(MESSAGE_ERROR, "Failed to start simulation thread: Failed to create condition: %s", SDL_GetMESSAGE_ERROR());
+                destroy_pipeline_primitives();
+                return;
+        }
+
+        simulation_quitting = false;
+        if (!(simulation_thread = SDL_CreateThread(run_simulation_thread, "Simulation", NULL))) {
+                send_message(MESSAGE_ERROR, "Failed to start simulation thread: Failed to create thread: %s", SDL_GetMESSAGE_ERROR());
+                destroy_pipeline_primitives();
+                return;
+        }
+}
+
+void terminate_frame_pipeline(void) {
+        if (simulation_thread) {
+                SDL_LockMutex(pipeline_mutex);
+                wait_for_frame_build();
+                simulation_quitting = true;
+                SDL_CondSignal(simulation_condition);
+                SDL_UnlockMutex(pipeline_mutex);
+
+                SDL_WaitThread(simulation_thread, NULL);
+                simulation_thread = NULL;
+        }
+
+        destroy_pipeline_primitives();
+        destroy_frame_packets();
+        frame_builder = NULL;
+        simulation_requested = false;
+        simulation_building = false;
+        pipeline_primed = false;
+        gathered_event_count = 0ULL;
+        frame_event_count = 0ULL;
+        frame_event_index = 0ULL;
+        events_in_flight = false;
+}
+
+bool is_frame_event_queue_full(void) {
+        return gathered_event_count == FRAME_EVENT_CAPACITY;
+}
+
+bool push_frame_event(const SDL_Event *const event) {
+        if (gathered_event_count == FRAME_EVENT_CAPACITY) {
+                return false;
+        }
+
+        gathered_events[gathered_event_count++] = *event;
+        return true;
+}
+
+bool poll_frame_event(SDL_Event *const out_event) {
+        if (frame_event_index == frame_event_count) {
+                return false;
+        }
+
+        *out_event = frame_events[frame_event_index++];
+        return true;
+}
+
+bool submit_frame(const double delta_time) {
+        if (!frame_builder) {
+                return false;
+        }
+
+        if (!simulation_thread) {
+                hand_frame_events();
+                refresh_context_size();
+                build_frame_packet(delta_time);
+                replay_frame_packet(&frame_packets[building_packet_index]);
+                events_in_flight = false;
+                return true;
+        }
+
+        SDL_LockMutex(pipeline_mutex);
+
+        // The very first frame has nothing built ahead of it yet
+        if (!pipeline_primed) {
+                request_frame_build(delta_time);
+                pipeline_primed = true;
+        }
+
+        wait_for_frame_build();
+
+        const size_t built_packet_index = building_packet_index;
+        building_packet_index = (building_packet_index + 1ULL) % FRAME_PACKET_COUNT;
+        request_frame_build(delta_time);
+
+        SDL_UnlockMutex(pipeline_mutex);
+
+        replay_frame_packet(&frame_packets[built_packet_index]);
+        return true;
+}
+
+bool is_frame_pipeline_idle(void) {
+        const size_t presented_packet_index = simulation_thread ? (building_packet_index + FRAME_PACKET_COUNT - 1ULL) % FRAME_PACKET_COUNT : building_packet_index;
+        return frame_packets[presented_packet_index].idle && !events_in_flight;
+}
+
+void run_frame_task(void (*const task)(void *), void *const data) {
+        if (!simulation_thread || SDL_ThreadID() == render_thread_id) {
+                task(data);
+                return;
+        }
+
+        struct FrameTask frame_task = {
+                .function = task,
+                .data = data,
+                .done = false,
+                .next = NULL
+        };
+
+        SDL_LockMutex(pipeline_mutex);
+        if (last_pending_task) {
+                last_pending_task->next = &frame_task;
+        } else {
+                first_pending_task = &frame_task;
+        }
+
+        last_pending_task = &frame_task;
+        SDL_CondSignal(render_condition);
+
+        while (!frame_task.done) {
+                SDL_CondWait(task_condition, pipeline_mutex);
+        }
+
+        SDL_UnlockMutex(pipeline_mutex);
+}
+
+// ================================================================================================
+// Textures
+// ================================================================================================
+
+struct TextureCreation {
+        Uint32 format;
+        int access;
+        int width;
+        int height;
+        SDL_BlendMode blend_mode;
+        SDL_Texture *texture;
+};
+
+static void run_texture_creation(void *const data) {
+        struct TextureCreation *const creation = (struct TextureCreation *)data;
+        creation->texture = SDL_CreateTexture(get_context_renderer(), creation->format, creation->access, creation->width, creation->height);
+        if (creation->texture) {
+                SDL_SetTextureBlendMode(creation->texture, creation->blend_mode);
+        }
+}
+
+SDL_Texture *create_frame_texture(const Uint32 format, const int access, const int width, const int height, const SDL_BlendMode blend_mode) {
+        struct TextureCreation creation = {
+                .format = format,
+                .access = access,
+                .width = width,
+                .height = height,
+                .blend_mode = blend_mode,
+                .texture = NULL
+        };
+
+        run_frame_task(run_texture_creation, &creation);
+        return creation.texture;
+}
+
+struct TextureUpdate {
+        SDL_Texture *texture;
+        const SDL_Rect *rectangle;
+        const void *pixels;
+        int pitch;
+};
+
+static void run_texture_update(void *const data) {
+        const struct TextureUpdate *const update = (const struct TextureUpdate *)data;
+        SDL_UpdateTexture(update->texture, update->rectangle, update->pixels, update->pitch);
+}
+
+// Uploads recorded into a frame carry their own copy of the pixels, so the texture keeps its previous contents for the frame
+// being presented, and only changes once the frame that asked for the upload is replayed
+void update_frame_texture(SDL_Texture *const texture, const SDL_Rect *const rectangle, const void *const pixels, const int pitch) {
+        if (!recording) {
+                struct TextureUpdate update = {
+                        .texture = texture,
+                        .rectangle = rectangle,
+                        .pixels = pixels,
+                        .pitch = pitch
+                };
+
+                run_frame_task(run_texture_update, &update);
+                return;
+        }
+
+        Uint32 format;
+        int texture_width;
+        int texture_height;
+        if (SDL_QueryTexture(texture, &format, NULL, &texture_width, &texture_height) < 0) {
+                send_message(MESSAGE_ERROR, "Failed to update frame texture: Failed to query texture: %s", SDL_GetMESSAGE_ERROR());
+                return;
+        }
+
+        const SDL_Rect region = rectangle ? *rectangle : (SDL_Rect){ .x = 0, .y = 0, .w = texture_width, .h = texture_height };
+        if (region.w <= 0 || region.h <= 0) {
+                return;
+        }
+
+        struct FramePacket *const packet = &frame_packets[building_packet_index];
+        const size_t row_size = (size_t)region.w * (size_t)SDL_BYTESPERPIXEL(format);
+        secure_packet_capacity((void **)&packet->pixels, &packet->pixel_capacity, packet->pixel_count + row_size * (size_t)region.h, sizeof(uint8_t));
+
+        for (int row = 0; row < region.h; ++row) {
+                memcpy(packet->pixels + packet->pixel_count + row_size * (size_t)row, (const uint8_t *)pixels + (size_t)pitch * (size_t)row, row_size);
+        }
+
+        struct FrameCommand *const command = push_frame_command(FRAME_COMMAND_TEXTURE_UPDATE);
+        command->texture = texture;
+        command->rectangle = region;
+        command->first_pixel = packet->pixel_count;
+        command->pitch = (int)row_size;
+
+        packet->pixel_count += row_size * (size_t)region.h;
+}
+
+void destroy_frame_texture(SDL_Texture *const texture) {
+        if (!texture) {
+                return;
+        }
+
+        if (!recording) {
+                SDL_DestroyTexture(texture);
+                return;
+        }
+
+        struct FramePacket *const packet = &frame_packets[building_packet_index];
+        secure_packet_capacity((void **)&packet->released_textures, &packet->released_texture_capacity, packet->released_texture_count + 1ULL, sizeof(SDL_Texture *));
+        packet->released_textures[packet->released_texture_count++] = texture;
+}
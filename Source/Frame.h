@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "SDL.h"
+
+void initialize_frame_pipeline(bool (*const build_frame)(const double delta_time), const bool threaded);
+
+void terminate_frame_pipeline(void);
+
+bool is_frame_event_queue_full(void);
+
+bool push_frame_event(const SDL_Event *const event);
+
+bool poll_frame_event(SDL_Event *const out_event);
+
+bool submit_frame(const double delta_time);
+
+bool is_frame_pipeline_idle(void);
+
+void run_frame_task(void (*const task)(void *), void *const data);
+
+void get_frame_viewport_size(int *const out_width, int *const out_height);
+
+void record_frame_clear(const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a);
+
+void record_frame_geometry(
+        const float *const positions,
+        const uint8_t *const colors,
+        const size_t vertex_count,
+        const uint32_t *const indices,
+        const size_t index_count
+);
+
+void record_frame_textured_geometry(
+        SDL_Texture *const texture,
+        const SDL_Vertex *const vertices,
+        const size_t vertex_count,
+        const int *const indices,
+        const size_t index_count
+);
+
+void record_frame_copy(SDL_Texture *const texture, const SDL_Rect *const destination, const double angle);
+
+void record_frame_render_target(SDL_Texture *const texture);
+
+SDL_Texture *get_frame_render_target(void);
+
+void record_frame_cursor(SDL_Cursor *const cursor);
+
+SDL_Texture *create_frame_texture(const Uint32 format, const int access, const int width, const int height, const SDL_BlendMode blend_mode);
+
+void update_frame_texture(SDL_Texture *const texture, const SDL_Rect *const rectangle, const void *const pixels, const int pitch);
+
+void destroy_frame_texture(SDL_Texture *const texture);
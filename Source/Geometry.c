@@ -5,30 +5,40 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <errno.h>
+#include <string.h>
 
 #include "SDL.h"
 
 #include "Utilities.h"
 #include "Context.h"
+#include "Frame.h"
 
 #define INITIAL_VERTEX_CAPACITY 64ULL
 #define INITIAL_INDEX_CAPACITY  64ULL
 
-#define INDEX_STRIDE           (sizeof(uint16_t))
+#define INDEX_STRIDE           (sizeof(uint32_t))
 #define VERTEX_POSITION_STRIDE (sizeof(float) * 2ULL)
 #define VERTEX_COLOR_STRIDE    (sizeof(uint8_t) * 4ULL)
 
-#define SEGMENT_LENGTH 4.0f
+#define MAXIMUM_BEZIER_DEPTH 12
+
+// Partially visible geometry is culled in chunks of this many triangles
+#define CULLING_CHUNK_INDEX_COUNT (64ULL * 3ULL)
+
+#define GEOMETRY_ARENA_INITIAL_SIZE (256ULL * 1024ULL)
+#define GEOMETRY_ARENA_ALIGNMENT    16ULL
 
 static size_t tracked_vertex_count = 0ULL;
 static size_t tracked_index_count = 0ULL;
+static size_t tracked_batch_count = 0ULL;
 
 void track_geometry_data(void) {
         tracked_vertex_count = 0ULL;
         tracked_index_count = 0ULL;
+        tracked_batch_count = 0ULL;
 }
 
-void get_tracked_geometry_data(size_t *const out_vertex_count, size_t *const out_index_count) {
+void get_tracked_geometry_data(size_t *const out_vertex_count, size_t *const out_index_count, size_t *const out_batch_count) {
         if (out_vertex_count != NULL) {
                 *out_vertex_count = tracked_vertex_count;
         }
@@ -36,53 +46,333 @@ void get_tracked_geometry_data(size_t *const out_vertex_count, size_t *const out
         if (out_index_count != NULL) {
                 *out_index_count = tracked_index_count;
         }
+
+        if (out_batch_count != NULL) {
+                *out_batch_count = tracked_batch_count;
+        }
+}
+
+// ================================================================================================
+// Quality
+// ================================================================================================
+
+// How far (in drawable pixels) a tessellated curve is allowed to stray from the real one. Since the geometry is written in
+// drawable pixels already, the same tolerance gives the same visual quality at every resolution and DPI.
+static const float geometry_quality_tolerances[GEOMETRY_QUALITY_COUNT] = {
+        [GEOMETRY_QUALITY_LOW]    = 1.0f,
+        [GEOMETRY_QUALITY_MEDIUM] = 0.5f,
+        [GEOMETRY_QUALITY_HIGH]   = 0.2f
+};
+
+static enum GeometryQuality geometry_quality = GEOMETRY_QUALITY_HIGH;
+
+void set_geometry_quality(const enum GeometryQuality quality) {
+        if (quality >= GEOMETRY_QUALITY_COUNT) {
+                send_message(MESSAGE_WARNING, "Geometry quality given to set is invalid");
+                return;
+        }
+
+        geometry_quality = quality;
+}
+
+enum GeometryQuality get_geometry_quality(void) {
+        return geometry_quality;
+}
+
+// Returns how many segments an arc of the given radius needs for each chord to stay within the tolerance of the arc
+static inline size_t compute_arc_resolution(const float radius, const float angle_span) {
+        const float tolerance = geometry_quality_tolerances[geometry_quality];
+        if (radius <= tolerance) {
+                return 3ULL;
+        }
+
+        const float step = 2.0f * acosf(1.0f - tolerance / radius);
+        const size_t resolution = (size_t)ceilf(fabsf(angle_span) / step);
+        return MAXIMUM_VALUE(resolution, 3ULL);
+}
+
+// ================================================================================================
+// Frame Arena
+// ================================================================================================
+
+// Transient geometries (the ones that get cleared and rewritten every frame) take their buffers from this linear arena instead
+// of owning heap buffers. The whole arena is released at once by reset_geometry_arena() after the frame is presented, and if a
+// frame needed more than one chunk, the chunks are merged into one so that the next frame fits into a single contiguous block.
+struct GeometryArenaChunk {
+        struct GeometryArenaChunk *previous;
+        size_t size;
+        size_t used;
+        _Alignas(GEOMETRY_ARENA_ALIGNMENT) unsigned char data[];
+};
+
+static struct GeometryArenaChunk *geometry_arena = NULL;
+static size_t geometry_arena_generation = 1ULL;
+static size_t geometry_arena_frame_bytes = 0ULL;
+static size_t geometry_arena_previous_frame_bytes = 0ULL;
+static size_t geometry_arena_peak_bytes = 0ULL;
+
+// Tessellation jobs write transient geometries from several threads at once, so taking memory from the arena is guarded
+static SDL_SpinLock geometry_arena_lock = 0;
+
+static struct GeometryArenaChunk *create_geometry_arena_chunk(const size_t size, struct GeometryArenaChunk *const previous) {
+        struct GeometryArenaChunk *const chunk = (struct GeometryArenaChunk *)xmalloc(sizeof(struct GeometryArenaChunk) + size);
+        chunk->previous = previous;
+        chunk->size = size;
+        chunk->used = 0ULL;
+        return chunk;
+}
+
+static void *allocate_geometry_arena(const size_t size) {
+        const size_t aligned_size = (size + GEOMETRY_ARENA_ALIGNMENT - 1ULL) & ~(GEOMETRY_ARENA_ALIGNMENT - 1ULL);
+
+        SDL_AtomicLock(&geometry_arena_lock);
+        if (geometry_arena == NULL || geometry_arena->used + aligned_size > geometry_arena->size) {
+                size_t chunk_size = geometry_arena ? geometry_arena->size * 2ULL : GEOMETRY_ARENA_INITIAL_SIZE;
+                while (chunk_size < aligned_size) {
+                        chunk_size *= 2ULL;
+                }
+
+                geometry_arena = create_geometry_arena_chunk(chunk_size, geometry_arena);
+        }
+
+        void *const allocated = geometry_arena->data + geometry_arena->used;
+        geometry_arena->used += aligned_size;
+        geometry_arena_frame_bytes += aligned_size;
+        SDL_AtomicUnlock(&geometry_arena_lock);
+        return allocated;
 }
 
+void reset_geometry_arena(void) {
+        if (geometry_arena == NULL) {
+                return;
+        }
+
+        if (geometry_arena->previous != NULL) {
+                size_t total_size = 0ULL;
+                for (struct GeometryArenaChunk *chunk = geometry_arena; chunk != NULL;) {
+                        struct GeometryArenaChunk *const previous = chunk->previous;
+                        total_size += chunk->size;
+                        xfree(chunk);
+                        chunk = previous;
+                }
+
+                geometry_arena = create_geometry_arena_chunk(total_size, NULL);
+        }
+
+        if (geometry_arena_frame_bytes > geometry_arena_peak_bytes) {
+                geometry_arena_peak_bytes = geometry_arena_frame_bytes;
+        }
+
+        geometry_arena_previous_frame_bytes = geometry_arena_frame_bytes;
+        geometry_arena_frame_bytes = 0ULL;
+        geometry_arena->used = 0ULL;
+
+        // Invalidates the buffers of every transient geometry at once
+        ++geometry_arena_generation;
+}
+
+void terminate_geometry_arena(void) {
+        for (struct GeometryArenaChunk *chunk = geometry_arena; chunk != NULL;) {
+                struct GeometryArenaChunk *const previous = chunk->previous;
+                xfree(chunk);
+                chunk = previous;
+        }
+
+        geometry_arena = NULL;
+}
+
+void get_geometry_arena_data(size_t *const out_frame_bytes, size_t *const out_peak_bytes, size_t *const out_capacity_bytes) {
+        if (out_frame_bytes != NULL) {
+                *out_frame_bytes = geometry_arena_previous_frame_bytes;
+        }
+
+        if (out_peak_bytes != NULL) {
+                *out_peak_bytes = geometry_arena_peak_bytes;
+        }
+
+        if (out_capacity_bytes != NULL) {
+                *out_capacity_bytes = 0ULL;
+                for (const struct GeometryArenaChunk *chunk = geometry_arena; chunk != NULL; chunk = chunk->previous) {
+                        *out_capacity_bytes += chunk->size;
+                }
+        }
+}
+
+// ================================================================================================
+// Geometry
+// ================================================================================================
+
 struct Geometry {
         float *positions;
         uint8_t *colors;
         size_t vertex_count;
         size_t vertex_capacity;
-        uint16_t *indices;
+        uint32_t *indices;
         size_t index_count;
         size_t index_capacity;
+        size_t peak_vertex_count;
+        size_t peak_index_count;
+        bool transient;
+        size_t arena_generation;
+        float minimum_x;
+        float minimum_y;
+        float maximum_x;
+        float maximum_y;
+        float *chunk_bounds;
+        size_t chunk_bounds_capacity;
+        bool outdated_chunk_bounds;
         uint8_t r;
         uint8_t g;
         uint8_t b;
         uint8_t a;
 };
 
+static inline void reset_geometry_bounds(struct Geometry *const geometry) {
+        geometry->minimum_x = FLT_MAX;
+        geometry->minimum_y = FLT_MAX;
+        geometry->maximum_x = -FLT_MAX;
+        geometry->maximum_y = -FLT_MAX;
+        geometry->outdated_chunk_bounds = true;
+}
+
 struct Geometry *create_geometry(void) {
         struct Geometry *const geometry = (struct Geometry *)xmalloc(sizeof(struct Geometry));
         geometry->vertex_capacity       = INITIAL_VERTEX_CAPACITY;
         geometry->index_capacity        = INITIAL_INDEX_CAPACITY;
         geometry->positions             = (float *)xmalloc(VERTEX_POSITION_STRIDE * geometry->vertex_capacity);
         geometry->colors                = (uint8_t *)xmalloc(VERTEX_COLOR_STRIDE * geometry->vertex_capacity);
-        geometry->indices               = (uint16_t *)xmalloc(INDEX_STRIDE * geometry->index_capacity);
+        geometry->indices               = (uint32_t *)xmalloc(INDEX_STRIDE * geometry->index_capacity);
+        geometry->vertex_count          = 0ULL;
+        geometry->index_count           = 0ULL;
+        geometry->peak_vertex_count     = 0ULL;
+        geometry->peak_index_count      = 0ULL;
+        geometry->transient             = false;
+        geometry->arena_generation      = 0ULL;
+        geometry->chunk_bounds          = NULL;
+        geometry->chunk_bounds_capacity = 0ULL;
+        geometry->r                     = 255;
+        geometry->g                     = 255;
+        geometry->b                     = 255;
+        geometry->a                     = 255;
+        reset_geometry_bounds(geometry);
+        return geometry;
+}
+
+struct Geometry *create_transient_geometry(void) {
+        struct Geometry *const geometry = (struct Geometry *)xmalloc(sizeof(struct Geometry));
+        geometry->vertex_capacity       = 0ULL;
+        geometry->index_capacity        = 0ULL;
+        geometry->positions             = NULL;
+        geometry->colors                = NULL;
+        geometry->indices               = NULL;
         geometry->vertex_count          = 0ULL;
         geometry->index_count           = 0ULL;
+        geometry->peak_vertex_count     = 0ULL;
+        geometry->peak_index_count      = 0ULL;
+        geometry->transient             = true;
+        geometry->arena_generation      = geometry_arena_generation;
+        geometry->chunk_bounds          = NULL;
+        geometry->chunk_bounds_capacity = 0ULL;
         geometry->r                     = 255;
         geometry->g                     = 255;
         geometry->b                     = 255;
         geometry->a                     = 255;
+        reset_geometry_bounds(geometry);
         return geometry;
 }
 
+static inline bool is_geometry_stale(const struct Geometry *const geometry) {
+        return geometry->transient && geometry->arena_generation != geometry_arena_generation;
+}
+
+static inline void refresh_transient_geometry(struct Geometry *const geometry) {
+        if (!is_geometry_stale(geometry)) {
+                return;
+        }
+
+        // The arena was reset since this geometry was written, so whatever it pointed to belongs to someone else now
+        geometry->positions        = NULL;
+        geometry->colors           = NULL;
+        geometry->indices          = NULL;
+        geometry->vertex_capacity  = 0ULL;
+        geometry->index_capacity   = 0ULL;
+        geometry->vertex_count     = 0ULL;
+        geometry->index_count      = 0ULL;
+        geometry->arena_generation = geometry_arena_generation;
+        reset_geometry_bounds(geometry);
+}
+
 void destroy_geometry(struct Geometry *const geometry) {
         if (geometry == NULL) {
                 send_message(MESSAGE_WARNING, "Geometry given to destroy is NULL");
                 return;
         }
 
-        xfree(geometry->positions);
-        xfree(geometry->colors);
-        xfree(geometry->indices);
+        size_t peak_vertex_count;
+        size_t peak_index_count;
+        get_geometry_peak_data(geometry, &peak_vertex_count, &peak_index_count);
+        send_message(MESSAGE_VERBOSE, "Destroying geometry with a peak of %zu vertices and %zu indices", peak_vertex_count, peak_index_count);
+
+        if (!geometry->transient) {
+                xfree(geometry->positions);
+                xfree(geometry->colors);
+                xfree(geometry->indices);
+        }
+
+        if (geometry->chunk_bounds != NULL) {
+                xfree(geometry->chunk_bounds);
+        }
+
         xfree(geometry);
 }
 
 void clear_geometry(struct Geometry *const geometry) {
+        if (geometry->vertex_count > geometry->peak_vertex_count) {
+                geometry->peak_vertex_count = geometry->vertex_count;
+        }
+
+        if (geometry->index_count > geometry->peak_index_count) {
+                geometry->peak_index_count = geometry->index_count;
+        }
+
         geometry->index_count = 0ULL;
         geometry->vertex_count = 0ULL;
+        reset_geometry_bounds(geometry);
+        refresh_transient_geometry(geometry);
+}
+
+bool get_geometry_bounds(const struct Geometry *const geometry, float *const out_x, float *const out_y, float *const out_w, float *const out_h) {
+        if (geometry->vertex_count == 0ULL || is_geometry_stale(geometry)) {
+                return false;
+        }
+
+        if (out_x != NULL) {
+                *out_x = geometry->minimum_x;
+        }
+
+        if (out_y != NULL) {
+                *out_y = geometry->minimum_y;
+        }
+
+        if (out_w != NULL) {
+                *out_w = geometry->maximum_x - geometry->minimum_x;
+        }
+
+        if (out_h != NULL) {
+                *out_h = geometry->maximum_y - geometry->minimum_y;
+        }
+
+        return true;
+}
+
+void get_geometry_peak_data(const struct Geometry *const geometry, size_t *const out_vertex_count, size_t *const out_index_count) {
+        if (out_vertex_count != NULL) {
+                *out_vertex_count = MAXIMUM_VALUE(geometry->peak_vertex_count, geometry->vertex_count);
+        }
+
+        if (out_index_count != NULL) {
+                *out_index_count = MAXIMUM_VALUE(geometry->peak_index_count, geometry->index_count);
+        }
 }
 
 void set_geometry_color(struct Geometry *const geometry, const uint16_t r, const uint16_t g, const uint16_t b, const uint16_t a) {
@@ -92,51 +382,286 @@ void set_geometry_color(struct Geometry *const geometry, const uint16_t r, const
         geometry->a = a;
 }
 
-void render_geometry(const struct Geometry *const geometry) {
+void translate_geometry(struct Geometry *const geometry, const float offset_x, const float offset_y) {
+        refresh_transient_geometry(geometry);
+
+        for (size_t vertex_index = 0ULL; vertex_index < geometry->vertex_count; ++vertex_index) {
+                geometry->positions[vertex_index * 2ULL + 0ULL] += offset_x;
+                geometry->positions[vertex_index * 2ULL + 1ULL] += offset_y;
+        }
+
+        if (geometry->vertex_count != 0ULL) {
+                geometry->minimum_x += offset_x;
+                geometry->minimum_y += offset_y;
+                geometry->maximum_x += offset_x;
+                geometry->maximum_y += offset_y;
+        }
+
+        geometry->outdated_chunk_bounds = true;
+}
+
+static inline void secure_geometry_vertex_capacity(struct Geometry *const geometry, const size_t required_vertex_capacity);
+static inline void secure_geometry_index_capacity(struct Geometry *const geometry, const size_t required_index_capacity);
+
+void write_rotated_geometry(
+        struct Geometry *const geometry,
+        const struct Geometry *const source,
+        const float pivot_x, const float pivot_y,
+        const float rotation
+) {
+        if (is_geometry_stale(source)) {
+                send_message(MESSAGE_WARNING, "Transient geometry given to write rotated was not rewritten this frame");
+                return;
+        }
+
+        secure_geometry_vertex_capacity(geometry, geometry->vertex_count + source->vertex_count);
+        secure_geometry_index_capacity(geometry, geometry->index_count + source->index_count);
+
+        const float sin = sinf(rotation);
+        const float cos = cosf(rotation);
+
+        float *const positions = geometry->positions + geometry->vertex_count * 2ULL;
+        for (size_t vertex_index = 0ULL; vertex_index < source->vertex_count; ++vertex_index) {
+                const float x = source->positions[vertex_index * 2ULL + 0ULL] - pivot_x;
+                const float y = source->positions[vertex_index * 2ULL + 1ULL] - pivot_y;
+
+                const float rotated_x = pivot_x + x * cos - y * sin;
+                const float rotated_y = pivot_y + x * sin + y * cos;
+                positions[vertex_index * 2ULL + 0ULL] = rotated_x;
+                positions[vertex_index * 2ULL + 1ULL] = rotated_y;
+
+                geometry->minimum_x = fminf(geometry->minimum_x, rotated_x);
+                geometry->minimum_y = fminf(geometry->minimum_y, rotated_y);
+                geometry->maximum_x = fmaxf(geometry->maximum_x, rotated_x);
+                geometry->maximum_y = fmaxf(geometry->maximum_y, rotated_y);
+        }
+
+        memcpy(geometry->colors + geometry->vertex_count * 4ULL, source->colors, VERTEX_COLOR_STRIDE * source->vertex_count);
+
+        const uint32_t base_index = (uint32_t)geometry->vertex_count;
+        for (size_t index = 0ULL; index < source->index_count; ++index) {
+                geometry->indices[geometry->index_count++] = base_index + source->indices[index];
+        }
+
+        geometry->vertex_count += source->vertex_count;
+        geometry->outdated_chunk_bounds = true;
+}
+
+// Geometry submitted with render_geometry() is queued here in draw order and only recorded into the frame when something that
+// isn't geometry (a texture copy, a present) has to be drawn, so consecutive geometries cost a single draw call between them.
+static struct Geometry *geometry_batch = NULL;
+
+static inline bool is_rectangle_outside_viewport(
+        const float minimum_x, const float minimum_y,
+        const float maximum_x, const float maximum_y,
+        const float viewport_width, const float viewport_height
+) {
+        return maximum_x < 0.0f || maximum_y < 0.0f || minimum_x > viewport_width || minimum_y > viewport_height;
+}
+
+// Bounds of every chunk of triangles, only worked out when a partially visible geometry needs them and kept until the
+// geometry is written to again
+static void update_geometry_chunk_bounds(struct Geometry *const geometry) {
+        if (!geometry->outdated_chunk_bounds) {
+                return;
+        }
+
+        const size_t chunk_count = (geometry->index_count + CULLING_CHUNK_INDEX_COUNT - 1ULL) / CULLING_CHUNK_INDEX_COUNT;
+        if (chunk_count > geometry->chunk_bounds_capacity) {
+                geometry->chunk_bounds_capacity = chunk_count;
+                geometry->chunk_bounds = (float *)xrealloc(geometry->chunk_bounds, sizeof(float) * 4ULL * geometry->chunk_bounds_capacity);
+        }
+
+        for (size_t chunk_index = 0ULL; chunk_index < chunk_count; ++chunk_index) {
+                const size_t first_index = chunk_index * CULLING_CHUNK_INDEX_COUNT;
+                const size_t last_index = MINIMUM_VALUE(first_index + CULLING_CHUNK_INDEX_COUNT, geometry->index_count);
+
+                float minimum_x = FLT_MAX, minimum_y = FLT_MAX;
+                float maximum_x = -FLT_MAX, maximum_y = -FLT_MAX;
+                for (size_t index = first_index; index < last_index; ++index) {
+                        const float *const position = geometry->positions + geometry->indices[index] * 2ULL;
+                        minimum_x = fminf(minimum_x, position[0]);
+                        minimum_y = fminf(minimum_y, position[1]);
+                        maximum_x = fmaxf(maximum_x, position[0]);
+                        maximum_y = fmaxf(maximum_y, position[1]);
+                }
+
+                float *const bounds = geometry->chunk_bounds + chunk_index * 4ULL;
+                bounds[0] = minimum_x;
+                bounds[1] = minimum_y;
+                bounds[2] = maximum_x;
+                bounds[3] = maximum_y;
+        }
+
+        geometry->outdated_chunk_bounds = false;
+}
+
+static inline void push_geometry_batch_indices(const struct Geometry *const geometry, const uint32_t base_index, const size_t first_index, const size_t last_index) {
+        uint32_t *const destination = geometry_batch->indices + geometry_batch->index_count;
+        for (size_t index = first_index; index < last_index; ++index) {
+                destination[index - first_index] = base_index + geometry->indices[index];
+        }
+
+        geometry_batch->index_count += last_index - first_index;
+}
+
+void render_geometry(struct Geometry *const geometry) {
+        if (is_geometry_stale(geometry)) {
+                send_message(MESSAGE_WARNING, "Transient geometry given to render was not rewritten this frame");
+                return;
+        }
+
+        if (geometry->index_count == 0ULL) {
+                return;
+        }
+
+        int frame_viewport_width;
+        int frame_viewport_height;
+        get_frame_viewport_size(&frame_viewport_width, &frame_viewport_height);
+
+        const float viewport_width  = (float)frame_viewport_width;
+        const float viewport_height = (float)frame_viewport_height;
+
+        if (is_rectangle_outside_viewport(geometry->minimum_x, geometry->minimum_y, geometry->maximum_x, geometry->maximum_y, viewport_width, viewport_height)) {
+                return;
+        }
+
+        if (geometry_batch == NULL) {
+                geometry_batch = create_geometry();
+        }
+
+        secure_geometry_vertex_capacity(geometry_batch, geometry_batch->vertex_count + geometry->vertex_count);
+        secure_geometry_index_capacity(geometry_batch, geometry_batch->index_count + geometry->index_count);
+
+        memcpy(geometry_batch->positions + geometry_batch->vertex_count * 2ULL, geometry->positions, VERTEX_POSITION_STRIDE * geometry->vertex_count);
+        memcpy(geometry_batch->colors    + geometry_batch->vertex_count * 4ULL, geometry->colors,    VERTEX_COLOR_STRIDE    * geometry->vertex_count);
+
+        const uint32_t base_index = (uint32_t)geometry_batch->vertex_count;
+        const size_t previous_index_count = geometry_batch->index_count;
+
+        const bool inside_viewport =
+                geometry->minimum_x >= 0.0f && geometry->maximum_x <= viewport_width &&
+                geometry->minimum_y >= 0.0f && geometry->maximum_y <= viewport_height;
+
+        if (inside_viewport) {
+                push_geometry_batch_indices(geometry, base_index, 0ULL, geometry->index_count);
+        } else {
+                update_geometry_chunk_bounds(geometry);
+
+                // Runs of visible chunks are pushed together so the copy loop stays as long as possible
+                size_t run_start = 0ULL;
+                bool run_visible = false;
+                for (size_t first_index = 0ULL; first_index < geometry->index_count; first_index += CULLING_CHUNK_INDEX_COUNT) {
+                        const float *const bounds = geometry->chunk_bounds + (first_index / CULLING_CHUNK_INDEX_COUNT) * 4ULL;
+                        const bool visible = !is_rectangle_outside_viewport(bounds[0], bounds[1], bounds[2], bounds[3], viewport_width, viewport_height);
+
+                        if (visible && !run_visible) {
+                                run_start = first_index;
+                        } else if (!visible && run_visible) {
+                                push_geometry_batch_indices(geometry, base_index, run_start, first_index);
+                        }
+
+                        run_visible = visible;
+                }
+
+                if (run_visible) {
+                        push_geometry_batch_indices(geometry, base_index, run_start, geometry->index_count);
+                }
+        }
+
+        geometry_batch->vertex_count += geometry->vertex_count;
+
         tracked_vertex_count += geometry->vertex_count;
-        tracked_index_count += geometry->index_count;
-        SDL_RenderGeometryRaw(
-                get_context_renderer(),        // Renderer
-                NULL,                          // Texture
-                geometry->positions,           // Positions
-                (int)VERTEX_POSITION_STRIDE,   // Position Stride
-                (SDL_Color *)geometry->colors, // Colors
-                (int)VERTEX_COLOR_STRIDE,      // Color Stride
-                NULL,                          // Texcoords
-                0,                             // Texcoord Stride
-                (int)geometry->vertex_count,   // Vertex Count
-                geometry->indices,             // Indices
-                (int)geometry->index_count,    // Index Count
-                (int)INDEX_STRIDE              // Index Size (Stride)
+        tracked_index_count += geometry_batch->index_count - previous_index_count;
+}
+
+void flush_geometry_batch(void) {
+        if (geometry_batch == NULL || geometry_batch->index_count == 0ULL) {
+                return;
+        }
+
+        ++tracked_batch_count;
+        record_frame_geometry(
+                geometry_batch->positions,
+                geometry_batch->colors,
+                geometry_batch->vertex_count,
+                geometry_batch->indices,
+                geometry_batch->index_count
         );
+
+        clear_geometry(geometry_batch);
+}
+
+void terminate_geometry_batch(void) {
+        if (geometry_batch == NULL) {
+                return;
+        }
+
+        destroy_geometry(geometry_batch);
+        geometry_batch = NULL;
 }
 
 static inline void secure_geometry_vertex_capacity(struct Geometry *const geometry, const size_t required_vertex_capacity) {
+        refresh_transient_geometry(geometry);
+
         if (required_vertex_capacity <= geometry->vertex_capacity) {
                 return;
         }
 
+        if (geometry->vertex_capacity == 0ULL) {
+                geometry->vertex_capacity = INITIAL_VERTEX_CAPACITY;
+        }
+
         while (geometry->vertex_capacity < required_vertex_capacity) {
                 geometry->vertex_capacity *= 2ULL;
         }
 
+        if (geometry->transient) {
+                float *const positions = (float *)allocate_geometry_arena(VERTEX_POSITION_STRIDE * geometry->vertex_capacity);
+                uint8_t *const colors  = (uint8_t *)allocate_geometry_arena(VERTEX_COLOR_STRIDE * geometry->vertex_capacity);
+                if (geometry->vertex_count != 0ULL) {
+                        memcpy(positions, geometry->positions, VERTEX_POSITION_STRIDE * geometry->vertex_count);
+                        memcpy(colors,    geometry->colors,    VERTEX_COLOR_STRIDE    * geometry->vertex_count);
+                }
+
+                geometry->positions = positions;
+                geometry->colors    = colors;
+                return;
+        }
+
         geometry->positions = (float *)xrealloc(geometry->positions, VERTEX_POSITION_STRIDE * geometry->vertex_capacity);
         geometry->colors    = (uint8_t *)xrealloc(geometry->colors, VERTEX_COLOR_STRIDE * geometry->vertex_capacity);
 }
 
 static inline void secure_geometry_index_capacity(struct Geometry *const geometry, const size_t required_index_capacity) {
+        refresh_transient_geometry(geometry);
+
         if (required_index_capacity <= geometry->index_capacity) {
                 return;
         }
 
+        if (geometry->index_capacity == 0ULL) {
+                geometry->index_capacity = INITIAL_INDEX_CAPACITY;
+        }
+
         while (geometry->index_capacity < required_index_capacity) {
                 geometry->index_capacity *= 2ULL;
         }
 
-        geometry->indices = (uint16_t *)xrealloc(geometry->indices, INDEX_STRIDE * geometry->index_capacity);
+        if (geometry->transient) {
+                uint32_t *const indices = (uint32_t *)allocate_geometry_arena(INDEX_STRIDE * geometry->index_capacity);
+                if (geometry->index_count != 0ULL) {
+                        memcpy(indices, geometry->indices, INDEX_STRIDE * geometry->index_count);
+                }
+
+                geometry->indices = indices;
+                return;
+        }
+
+        geometry->indices = (uint32_t *)xrealloc(geometry->indices, INDEX_STRIDE * geometry->index_capacity);
 }
 
-static inline uint16_t add_geometry_vertex(struct Geometry *const geometry, const float x, const float y) {
+static inline uint32_t add_geometry_vertex(struct Geometry *const geometry, const float x, const float y) {
         const size_t color_index = geometry->vertex_count * 4ULL;
         geometry->colors[color_index + 0ULL] = geometry->r;
         geometry->colors[color_index + 1ULL] = geometry->g;
@@ -147,7 +672,13 @@ static inline uint16_t add_geometry_vertex(struct Geometry *const geometry, cons
         geometry->positions[position_index + 0ULL] = x;
         geometry->positions[position_index + 1ULL] = y;
 
-        return (uint16_t)geometry->vertex_count++;
+        geometry->minimum_x = fminf(geometry->minimum_x, x);
+        geometry->minimum_y = fminf(geometry->minimum_y, y);
+        geometry->maximum_x = fmaxf(geometry->maximum_x, x);
+        geometry->maximum_y = fmaxf(geometry->maximum_y, y);
+        geometry->outdated_chunk_bounds = true;
+
+        return (uint32_t)geometry->vertex_count++;
 }
 
 void write_triangle_geometry(
@@ -237,10 +768,10 @@ void write_quadrilateral_geometry(
         secure_geometry_vertex_capacity(geometry, geometry->vertex_count + 4ULL);
         secure_geometry_index_capacity(geometry, geometry->index_count + 6ULL);
 
-        const uint16_t index1 = add_geometry_vertex(geometry, x1, y1);
-        const uint16_t index2 = add_geometry_vertex(geometry, x2, y2);
-        const uint16_t index3 = add_geometry_vertex(geometry, x3, y3);
-        const uint16_t index4 = add_geometry_vertex(geometry, x4, y4);
+        const uint32_t index1 = add_geometry_vertex(geometry, x1, y1);
+        const uint32_t index2 = add_geometry_vertex(geometry, x2, y2);
+        const uint32_t index3 = add_geometry_vertex(geometry, x3, y3);
+        const uint32_t index4 = add_geometry_vertex(geometry, x4, y4);
 
         geometry->indices[geometry->index_count++] = index1;
         geometry->indices[geometry->index_count++] = index2;
@@ -299,18 +830,12 @@ void write_elliptical_arc_geometry(
                 angle_span += 2.0f * (float)M_PI;
         }
 
-        const float circumference = M_PI * (3.0f * (rx + ry) - sqrtf((3.0f * rx + ry) * (rx + 3.0f * ry)));
-        const float arc_length = circumference * fabsf(angle_span) / (2.0f * (float)M_PI);
-
-        size_t resolution = (size_t)ceilf(arc_length / SEGMENT_LENGTH);
-        if (resolution < 3ULL) {
-                resolution = 3ULL;
-        }
+        const size_t resolution = compute_arc_resolution(MAXIMUM_VALUE(rx, ry), angle_span);
 
         secure_geometry_vertex_capacity(geometry, geometry->vertex_count + resolution + 2ULL);
         secure_geometry_index_capacity(geometry, geometry->index_count + (resolution + 1ULL) * 3ULL);
 
-        const uint16_t center_index = add_geometry_vertex(geometry, cx, cy);
+        const uint32_t center_index = add_geometry_vertex(geometry, cx, cy);
         for (size_t index = 0ULL; index <= resolution; ++index) {
                 float interpolation = (float)index / (float)resolution;
                 float angle = start_angle + interpolation * angle_span;
@@ -331,8 +856,8 @@ void write_elliptical_arc_geometry(
 
         for (size_t index = 0ULL; index < resolution; ++index) {
                 geometry->indices[geometry->index_count++] = center_index;
-                geometry->indices[geometry->index_count++] = center_index + 1 + (uint16_t)index;
-                geometry->indices[geometry->index_count++] = center_index + 1 + (uint16_t)((index + 1ULL));
+                geometry->indices[geometry->index_count++] = center_index + 1 + (uint32_t)index;
+                geometry->indices[geometry->index_count++] = center_index + 1 + (uint32_t)(index + 1ULL);
         }
 }
 
@@ -389,13 +914,8 @@ void write_elliptical_arc_outline_geometry(
                 angle_span += 2.0f * (float)M_PI;
         }
 
-        const float circumference = M_PI * (3.0f * (rx + ry) - sqrtf((3.0f * rx + ry) * (rx + 3.0f * ry)));
-        const float arc_length = circumference * fabsf(angle_span) / (2.0f * (float)M_PI);
-
-        size_t resolution = (size_t)ceilf(arc_length / SEGMENT_LENGTH);
-        if (resolution < 3ULL) {
-                resolution = 3ULL;
-        }
+        // The outer edge is the one that strays the furthest from the real arc
+        const size_t resolution = compute_arc_resolution(MAXIMUM_VALUE(rx, ry) + line_width / 2.0f, angle_span);
 
         secure_geometry_vertex_capacity(geometry, geometry->vertex_count + (resolution + 1ULL) * 2ULL);
         secure_geometry_index_capacity(geometry, geometry->index_count + resolution * 6ULL);
@@ -416,7 +936,7 @@ void write_elliptical_arc_outline_geometry(
 
         const float cos = cosf(rotation);
         const float sin = sinf(rotation);
-        const uint16_t start_index = (uint16_t)geometry->vertex_count;
+        const uint32_t start_index = (uint32_t)geometry->vertex_count;
 
         // HACK: Keeping track of the triangle vertices at the start and end of the triangle strip to accurately calculate the
         // positions (centers) of the line cap arcs since I can't get it to look aligned visually.
@@ -456,7 +976,7 @@ void write_elliptical_arc_outline_geometry(
                 add_geometry_vertex(geometry, cx + rx_inner, cy + ry_inner);
 
                 if (index < resolution) {
-                        const uint16_t base = start_index + (uint16_t)index * 2ULL;
+                        const uint32_t base = start_index + (uint32_t)index * 2ULL;
 
                         geometry->indices[geometry->index_count++] = base + 0;
                         geometry->indices[geometry->index_count++] = base + 1;
@@ -535,7 +1055,7 @@ void write_hexagon_geometry(
         secure_geometry_vertex_capacity(geometry, geometry->vertex_count + 6ULL);
         secure_geometry_index_capacity(geometry, geometry->index_count + 12ULL);
 
-        uint16_t vertices[6];
+        uint32_t vertices[6];
         static const float step = (float)M_PI / 3.0f;
         for (uint8_t index = 0; index < 6; index++) {
                 const float angle = rotation + step * (float)index;
@@ -605,66 +1125,80 @@ void write_bezier_curve_geometry(
         const float line_width
 ) {
 
-#define DISTANCE(x1, y1, x2, y2) (sqrtf(((x2) - (x1)) * ((x2) - (x1)) + ((y2) - (y1)) * ((y2) - (y1))))
-
-        const float curvature
-                = DISTANCE(px1, py1, cx1, cy1)
-                + DISTANCE(cx1, cy1, cx2, cy2)
-                + DISTANCE(cx2, cy2, px2, py2)
-                / DISTANCE(px1, py1, px2, py2);
-        size_t samples = (size_t)(curvature * 5.0f);
-        if (samples < 5ULL) {
-                samples = 5ULL;
-        }
-
-        float estimated_length = 0.0f;
-        float x1 = px1, y1 = py1;
-        for (size_t index = 1ULL; index <= samples; ++index) {
-                const float interpolation = (float)index / (float)samples;
-
-                float x2, y2;
-                compute_bezier_point(interpolation, px1, py1, cx1, cy1, cx2, cy2, px2, py2, &x2, &y2);
-                estimated_length += DISTANCE(x1, y1, x2, y2);
-                x1 = x2;
-                y1 = y2;
-        }
-
-#undef DISTANCE
-
-        const size_t resolution = (size_t)ceilf(estimated_length / SEGMENT_LENGTH);
-        if (resolution == 0ULL) {
-                return;
-        }
-
-        secure_geometry_vertex_capacity(geometry, geometry->vertex_count + (resolution + 1ULL) * 2ULL);
-        secure_geometry_index_capacity(geometry, geometry->index_count + resolution * 6ULL);
+        const float tolerance = geometry_quality_tolerances[geometry_quality];
+        const float half_width = line_width / 2.0f;
 
-        float tx, ty;
+        float x1, y1, tx, ty;
+        compute_bezier_point(  0.0f, px1, py1, px2, py2, cx1, cy1, cx2, cy2, &x1, &y1);
         compute_bezier_tangent(0.0f, px1, py1, px2, py2, cx1, cy1, cx2, cy2, &tx, &ty);
-        compute_bezier_point(0.0f, px1, py1, px2, py2, cx1, cy1, cx2, cy2, &x1, &y1);
-
-        const float half_width = line_width / 2.0f;
 
         float length = sqrtf(tx * tx + ty * ty);
         float nx = (length > 0.0f) ? (-ty / length) * half_width : 0.0f;
         float ny = (length > 0.0f) ? ( tx / length) * half_width : 0.0f;
 
-        uint16_t left1  = add_geometry_vertex(geometry, x1 - nx, y1 - ny);
-        uint16_t right1 = add_geometry_vertex(geometry, x1 + nx, y1 + ny);
+        secure_geometry_vertex_capacity(geometry, geometry->vertex_count + 2ULL);
+        uint32_t left1  = add_geometry_vertex(geometry, x1 - nx, y1 - ny);
+        uint32_t right1 = add_geometry_vertex(geometry, x1 + nx, y1 + ny);
 
-        for (size_t index = 1ULL; index <= resolution; ++index) {
-                const float interpolation = (float)index / (float)resolution;
+        // The curve is split in half until every piece is flat enough to be drawn as a single segment, so straight stretches
+        // get very few segments while tight bends get as many as they need. Pieces are handled left to right, which means
+        // the right halves go onto the stack first.
+        struct BezierInterval {
+                float start;
+                float end;
+                uint8_t depth;
+        } intervals[MAXIMUM_BEZIER_DEPTH + 1];
+
+        size_t interval_count = 0ULL;
+        intervals[interval_count++] = (struct BezierInterval){ 0.0f, 1.0f, 0 };
+
+        while (interval_count > 0ULL) {
+                const struct BezierInterval interval = intervals[--interval_count];
 
                 float x2, y2;
-                compute_bezier_point(  interpolation, px1, py1, px2, py2, cx1, cy1, cx2, cy2, &x2, &y2);
-                compute_bezier_tangent(interpolation, px1, py1, px2, py2, cx1, cy1, cx2, cy2, &tx, &ty);
+                compute_bezier_point(interval.end, px1, py1, px2, py2, cx1, cy1, cx2, cy2, &x2, &y2);
+
+                if (interval.depth < MAXIMUM_BEZIER_DEPTH) {
+                        const float span = interval.end - interval.start;
+
+                        float qx1, qy1, qx2, qy2;
+                        compute_bezier_point(interval.start + span / 3.0f,        px1, py1, px2, py2, cx1, cy1, cx2, cy2, &qx1, &qy1);
+                        compute_bezier_point(interval.start + span * 2.0f / 3.0f, px1, py1, px2, py2, cx1, cy1, cx2, cy2, &qx2, &qy2);
+
+                        // Distance of both probes from the chord, which catches S-shaped pieces that a single midpoint would miss
+                        const float chord_x = x2 - x1;
+                        const float chord_y = y2 - y1;
+                        const float chord_length = sqrtf(chord_x * chord_x + chord_y * chord_y);
+
+                        float deviation;
+                        if (chord_length > FLT_EPSILON) {
+                                const float deviation1 = fabsf((qx1 - x1) * chord_y - (qy1 - y1) * chord_x) / chord_length;
+                                const float deviation2 = fabsf((qx2 - x1) * chord_y - (qy2 - y1) * chord_x) / chord_length;
+                                deviation = MAXIMUM_VALUE(deviation1, deviation2);
+                        } else {
+                                deviation = MAXIMUM_VALUE(hypotf(qx1 - x1, qy1 - y1), hypotf(qx2 - x1, qy2 - y1));
+                        }
+
+                        if (deviation > tolerance) {
+                                const float middle = interval.start + span / 2.0f;
+                                const uint8_t depth = interval.depth + 1;
+                                intervals[interval_count++] = (struct BezierInterval){ middle, interval.end, depth };
+                                intervals[interval_count++] = (struct BezierInterval){ interval.start, middle, depth };
+                                continue;
+                        }
+                }
+
+                compute_bezier_tangent(interval.end, px1, py1, px2, py2, cx1, cy1, cx2, cy2, &tx, &ty);
 
                 length = sqrtf(tx * tx + ty * ty);
                 nx = (length > 0.0f) ? (-ty / length) * half_width : 0.0f;
                 ny = (length > 0.0f) ? ( tx / length) * half_width : 0.0f;
 
-                const uint16_t left2  = add_geometry_vertex(geometry, x2 - nx, y2 - ny);
-                const uint16_t right2 = add_geometry_vertex(geometry, x2 + nx, y2 + ny);
+                secure_geometry_vertex_capacity(geometry, geometry->vertex_count + 2ULL);
+                secure_geometry_index_capacity(geometry, geometry->index_count + 6ULL);
+
+                const uint32_t left2  = add_geometry_vertex(geometry, x2 - nx, y2 - ny);
+                const uint32_t right2 = add_geometry_vertex(geometry, x2 + nx, y2 + ny);
 
                 geometry->indices[geometry->index_count++] = left1;
                 geometry->indices[geometry->index_count++] = right1;
@@ -676,6 +1210,8 @@ void write_bezier_curve_geometry(
 
                 left1  = left2;
                 right1 = right2;
+                x1 = x2;
+                y1 = y2;
         }
 }
 
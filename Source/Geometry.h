@@ -8,16 +8,43 @@
 
 void track_geometry_data(void);
 
-void get_tracked_geometry_data(size_t *const out_vertex_count, size_t *const out_index_count);
+void get_tracked_geometry_data(size_t *const out_vertex_count, size_t *const out_index_count, size_t *const out_batch_count);
+
+void flush_geometry_batch(void);
+
+void terminate_geometry_batch(void);
+
+void reset_geometry_arena(void);
+
+void terminate_geometry_arena(void);
+
+void get_geometry_arena_data(size_t *const out_frame_bytes, size_t *const out_peak_bytes, size_t *const out_capacity_bytes);
+
+enum GeometryQuality {
+        GEOMETRY_QUALITY_LOW,
+        GEOMETRY_QUALITY_MEDIUM,
+        GEOMETRY_QUALITY_HIGH,
+        GEOMETRY_QUALITY_COUNT
+};
+
+void set_geometry_quality(const enum GeometryQuality quality);
+
+enum GeometryQuality get_geometry_quality(void);
 
 struct Geometry;
 
 struct Geometry *create_geometry(void);
 
+struct Geometry *create_transient_geometry(void);
+
 void destroy_geometry(struct Geometry *const geometry);
 
 void clear_geometry(struct Geometry *const geometry);
 
+void get_geometry_peak_data(const struct Geometry *const geometry, size_t *const out_vertex_count, size_t *const out_index_count);
+
+bool get_geometry_bounds(const struct Geometry *const geometry, float *const out_x, float *const out_y, float *const out_w, float *const out_h);
+
 void set_geometry_color(
         struct Geometry *const geometry,
         const uint16_t r,
@@ -26,7 +53,16 @@ void set_geometry_color(
         const uint16_t a
 );
 
-void render_geometry(const struct Geometry *const geometry);
+void translate_geometry(struct Geometry *const geometry, const float offset_x, const float offset_y);
+
+void write_rotated_geometry(
+        struct Geometry *const geometry,
+        const struct Geometry *const source,
+        const float pivot_x, const float pivot_y,
+        const float rotation
+);
+
+void render_geometry(struct Geometry *const geometry);
 
 enum LineCap {
         LINE_CAP_NONE  = 0,
@@ -41,7 +41,7 @@ static inline void get_event_position(const SDL_Event *const event, const int sc
 
 enum Input handle_gesture_event(const SDL_Event *const event) {
         int screen_width, screen_height;
-        SDL_GetWindowSize(get_context_window(), &screen_width, &screen_height);
+        get_context_window_size(&screen_width, &screen_height);
 
         float x, y;
 
@@ -0,0 +1,1002 @@
+#include "Glyphs.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+#include "Context.h"
+#include "Frame.h"
+#include "Utilities.h"
+#include "Persistent.h"
+#include "Profiler.h"
+
+#define INITIAL_ATLAS_SIZE 256
+#define MAXIMUM_ATLAS_SIZE 4096
+#define ATLAS_PADDING      1
+
+#define INITIAL_GLYPH_CAPACITY 128ULL
+#define EMPTY_CODEPOINT        UINT32_MAX
+
+#define FALLBACK_CODEPOINT '?'
+
+struct GlyphEntry {
+        uint32_t codepoint;
+        bool pending;
+        struct Glyph glyph;
+};
+
+// Every glyph is rasterized in white exactly once into the atlas of its font, text is then drawn as quads sampling from it
+// and gets its color from the vertices. The surface is the source of truth, the texture only gets the parts that changed.
+struct GlyphAtlas {
+        SDL_Surface *surface;
+        SDL_Texture *texture;
+        bool modified;
+        bool dirty;
+        SDL_Rect dirty_rectangle;
+        int shelf_x;
+        int shelf_y;
+        int shelf_height;
+        struct GlyphEntry *entries;
+        size_t entry_capacity;
+        size_t entry_count;
+};
+
+static struct GlyphAtlas atlases[FONT_COUNT];
+
+static inline size_t hash_codepoint(const uint32_t codepoint) {
+        return (size_t)(codepoint * 2654435761U);
+}
+
+static bool initialize_glyph_atlas(struct GlyphAtlas *const atlas) {
+        if (!(atlas->surface = SDL_CreateRGBSurfaceWithFormat(0, INITIAL_ATLAS_SIZE, INITIAL_ATLAS_SIZE, 32, SDL_PIXELFORMAT_ARGB8888))) {
+                send_message(MESSAGE_ERROR, "Failed to initialize glyph atlas: Failed to create surface: %s", SDL_GetMESSAGE_ERROR());
+                return false;
+        }
+
+        atlas->texture = NULL;
+        atlas->modified = false;
+        atlas->dirty = false;
+        atlas->shelf_x = ATLAS_PADDING;
+        atlas->shelf_y = ATLAS_PADDING;
+        atlas->shelf_height = 0;
+
+        atlas->entry_capacity = INITIAL_GLYPH_CAPACITY;
+        atlas->entry_count = 0ULL;
+        atlas->entries = (struct GlyphEntry *)xmalloc(sizeof(struct GlyphEntry) * atlas->entry_capacity);
+        for (size_t entry_index = 0ULL; entry_index < atlas->entry_capacity; ++entry_index) {
+                atlas->entries[entry_index].codepoint = EMPTY_CODEPOINT;
+        }
+
+        return true;
+}
+
+// Leaves the atlas the way it was before it got initialized, so that its glyphs get rasterized again on demand
+static void discard_glyph_atlas(struct GlyphAtlas *const atlas) {
+        SDL_FreeSurface(atlas->surface);
+        xfree(atlas->entries);
+        *atlas = (struct GlyphAtlas){ 0 };
+}
+
+static struct GlyphEntry *find_glyph_entry(const struct GlyphAtlas *const atlas, const uint32_t codepoint) {
+        const size_t mask = atlas->entry_capacity - 1ULL;
+        for (size_t entry_index = hash_codepoint(codepoint) & mask;; entry_index = (entry_index + 1ULL) & mask) {
+                struct GlyphEntry *const entry = &atlas->entries[entry_index];
+                if (entry->codepoint == codepoint || entry->codepoint == EMPTY_CODEPOINT) {
+                        return entry;
+                }
+        }
+}
+
+static void insert_glyph_entry(struct GlyphAtlas *const atlas, const uint32_t codepoint, const struct Glyph *const glyph) {
+        // Kept at most half full so that probing stays short
+        if ((atlas->entry_count + 1ULL) * 2ULL > atlas->entry_capacity) {
+                struct GlyphEntry *const previous_entries = atlas->entries;
+                const size_t previous_capacity = atlas->entry_capacity;
+
+                atlas->entry_capacity *= 2ULL;
+                atlas->entries = (struct GlyphEntry *)xmalloc(sizeof(struct GlyphEntry) * atlas->entry_capacity);
+                for (size_t entry_index = 0ULL; entry_index < atlas->entry_capacity; ++entry_index) {
+                        atlas->entries[entry_index].codepoint = EMPTY_CODEPOINT;
+                }
+
+                for (size_t entry_index = 0ULL; entry_index < previous_capacity; ++entry_index) {
+                        if (previous_entries[entry_index].codepoint != EMPTY_CODEPOINT) {
+                                *find_glyph_entry(atlas, previous_entries[entry_index].codepoint) = previous_entries[entry_index];
+                        }
+                }
+
+                xfree(previous_entries);
+        }
+
+        struct GlyphEntry *const entry = find_glyph_entry(atlas, codepoint);
+        entry->codepoint = codepoint;
+        entry->pending = false;
+        entry->glyph = *glyph;
+        ++atlas->entry_count;
+        atlas->modified = true;
+}
+
+static bool grow_glyph_atlas(struct GlyphAtlas *const atlas) {
+        if (atlas->surface->w >= MAXIMUM_ATLAS_SIZE) {
+                send_message(MESSAGE_ERROR, "Failed to grow glyph atlas: Atlas is already %dx%d", atlas->surface->w, atlas->surface->h);
+                return false;
+        }
+
+        const int size = atlas->surface->w * 2;
+        SDL_Surface *const surface = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!surface) {
+                send_message(MESSAGE_ERROR, "Failed to grow glyph atlas: Failed to create surface: %s", SDL_GetMESSAGE_ERROR());
+                return false;
+        }
+
+        // Glyphs keep their atlas positions, so text laid out before the atlas grew stays valid
+        SDL_SetSurfaceBlendMode(atlas->surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(atlas->surface, NULL, surface, NULL);
+        SDL_FreeSurface(atlas->surface);
+        atlas->surface = surface;
+
+        if (atlas->texture) {
+                destroy_frame_texture(atlas->texture);
+                atlas->texture = NULL;
+        }
+
+        atlas->dirty = false;
+        return true;
+}
+
+static bool pack_glyph(struct GlyphAtlas *const atlas, const int width, const int height, int *const out_x, int *const out_y) {
+        while (true) {
+                if (atlas->shelf_x + width + ATLAS_PADDING > atlas->surface->w) {
+                        atlas->shelf_x = ATLAS_PADDING;
+                        atlas->shelf_y += atlas->shelf_height + ATLAS_PADDING;
+                        atlas->shelf_height = 0;
+                }
+
+                if (atlas->shelf_y + height + ATLAS_PADDING <= atlas->surface->h && width + ATLAS_PADDING * 2 <= atlas->surface->w) {
+                        break;
+                }
+
+                if (!grow_glyph_atlas(atlas)) {
+                        return false;
+                }
+        }
+
+        *out_x = atlas->shelf_x;
+        *out_y = atlas->shelf_y;
+        atlas->shelf_x += width + ATLAS_PADDING;
+        atlas->shelf_height = MAXIMUM_VALUE(atlas->shelf_height, height);
+        return true;
+}
+
+// Only touches the given font, so the worker thread can call it with its own font instances
+static bool rasterize_glyph(TTF_Font *const font, const uint32_t codepoint, struct Glyph *const out_glyph, SDL_Surface **const out_surface) {
+        int minimum_x;
+        int maximum_x;
+        int minimum_y;
+        int maximum_y;
+        int advance;
+        if (TTF_GlyphMetrics32(font, codepoint, &minimum_x, &maximum_x, &minimum_y, &maximum_y, &advance) < 0) {
+                return false;
+        }
+
+        // The rendered glyph starts at the leftmost of the pen position and the glyph's own left side
+        out_glyph->offset_x = MINIMUM_VALUE(minimum_x, 0);
+        out_glyph->advance = advance;
+        out_glyph->atlas_x = 0;
+        out_glyph->atlas_y = 0;
+        out_glyph->width = 0;
+        out_glyph->height = 0;
+        *out_surface = NULL;
+
+        // Whitespace and other invisible glyphs only move the pen
+        if (maximum_x <= minimum_x || maximum_y <= minimum_y) {
+                return true;
+        }
+
+        return (*out_surface = TTF_RenderGlyph32_Blended(font, codepoint, (SDL_Color){ COLOR_WHITE, COLOR_OPAQUE })) != NULL;
+}
+
+static bool place_glyph(struct GlyphAtlas *const atlas, SDL_Surface *const glyph_surface, struct Glyph *const glyph) {
+        if (!glyph_surface) {
+                return true;
+        }
+
+        int x;
+        int y;
+        if (!pack_glyph(atlas, glyph_surface->w, glyph_surface->h, &x, &y)) {
+                return false;
+        }
+
+        SDL_Rect destination = (SDL_Rect){ .x = x, .y = y, .w = glyph_surface->w, .h = glyph_surface->h };
+        SDL_SetSurfaceBlendMode(glyph_surface, SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(glyph_surface, NULL, atlas->surface, &destination);
+
+        glyph->atlas_x = x;
+        glyph->atlas_y = y;
+        glyph->width = glyph_surface->w;
+        glyph->height = glyph_surface->h;
+        atlas->modified = true;
+
+        if (!atlas->dirty) {
+                atlas->dirty_rectangle = destination;
+                atlas->dirty = true;
+        } else {
+                SDL_UnionRect(&atlas->dirty_rectangle, &destination, &atlas->dirty_rectangle);
+        }
+
+        return true;
+}
+
+bool get_glyph(const enum Font font, const uint32_t codepoint, struct Glyph *const out_glyph) {
+        struct GlyphAtlas *const atlas = &atlases[font];
+        if (!atlas->surface && !initialize_glyph_atlas(atlas)) {
+                return false;
+        }
+
+        const struct GlyphEntry *const entry = find_glyph_entry(atlas, codepoint);
+        if (entry->codepoint == codepoint && !entry->pending) {
+                *out_glyph = entry->glyph;
+                return true;
+        }
+
+        TTF_Font *const ttf_font = get_font(font);
+
+        // Codepoints the font doesn't have share the glyph of the fallback codepoint
+        if (codepoint != FALLBACK_CODEPOINT && !TTF_GlyphIsProvided32(ttf_font, codepoint)) {
+                if (!get_glyph(font, FALLBACK_CODEPOINT, out_glyph)) {
+                        return false;
+                }
+        } else {
+                SDL_Surface *glyph_surface;
+                if (!rasterize_glyph(ttf_font, codepoint, out_glyph, &glyph_surface)) {
+                        send_message(MESSAGE_ERROR, "Failed to rasterize glyph U+%04X: %s", (unsigned int)codepoint, TTF_GetMESSAGE_ERROR());
+                        return false;
+                }
+
+                const bool placed = place_glyph(atlas, glyph_surface, out_glyph);
+                SDL_FreeSurface(glyph_surface);
+                if (!placed) {
+                        send_message(MESSAGE_ERROR, "Failed to rasterize glyph U+%04X: Failed to find room in the atlas", (unsigned int)codepoint);
+                        return false;
+                }
+        }
+
+        // The worker may still deliver this glyph later, which then finds it already resolved and drops its copy
+        struct GlyphEntry *const pending_entry = find_glyph_entry(atlas, codepoint);
+        if (pending_entry->codepoint == codepoint) {
+                pending_entry->glyph = *out_glyph;
+                pending_entry->pending = false;
+                return true;
+        }
+
+        insert_glyph_entry(atlas, codepoint, out_glyph);
+        return true;
+}
+
+// ================================================================================================
+// Worker
+// ================================================================================================
+
+struct GlyphRequest {
+        enum Font font;
+        TTF_Font *instance;
+        uint32_t codepoint;
+};
+
+struct GlyphResult {
+        enum Font font;
+        uint32_t codepoint;
+        bool provided;
+        bool rasterized;
+        struct Glyph glyph;
+        SDL_Surface *surface;
+};
+
+// The worker owns a separate instance of each font, FreeType faces can't be shared between threads
+static SDL_Thread *glyph_worker = NULL;
+static bool glyph_worker_failed = false;
+static bool glyph_worker_quitting = false;
+static SDL_mutex *glyph_queue_mutex = NULL;
+static SDL_cond *glyph_queue_condition = NULL;
+static TTF_Font *worker_fonts[FONT_COUNT];
+static size_t atlas_generations[FONT_COUNT];
+
+static struct GlyphRequest *glyph_requests = NULL;
+static size_t glyph_request_head = 0ULL;
+static size_t glyph_request_count = 0ULL;
+static size_t glyph_request_capacity = 0ULL;
+
+static struct GlyphResult *glyph_results = NULL;
+static size_t glyph_result_count = 0ULL;
+static size_t glyph_result_capacity = 0ULL;
+static size_t outstanding_glyph_count = 0ULL;
+
+static struct GlyphResult *drained_results = NULL;
+static size_t drained_result_capacity = 0ULL;
+
+static int run_glyph_worker(void *const data) {
+        (void)data;
+
+        SDL_LockMutex(glyph_queue_mutex);
+        while (true) {
+                while (glyph_request_head == glyph_request_count && !glyph_worker_quitting) {
+                        SDL_CondWait(glyph_queue_condition, glyph_queue_mutex);
+                }
+
+                if (glyph_worker_quitting) {
+                        break;
+                }
+
+                const struct GlyphRequest request = glyph_requests[glyph_request_head++];
+                if (glyph_request_head == glyph_request_count) {
+                        glyph_request_head = 0ULL;
+                        glyph_request_count = 0ULL;
+                }
+
+                SDL_UnlockMutex(glyph_queue_mutex);
+
+                struct GlyphResult result = (struct GlyphResult){
+                        .font = request.font,
+                        .codepoint = request.codepoint,
+                        .provided = request.codepoint == FALLBACK_CODEPOINT || TTF_GlyphIsProvided32(request.instance, request.codepoint),
+                        .rasterized = false,
+                        .surface = NULL
+                };
+
+                if (result.provided) {
+                        PROFILE_SCOPE("rasterize_glyph") {
+                                result.rasterized = rasterize_glyph(request.instance, request.codepoint, &result.glyph, &result.surface);
+                        }
+                }
+
+                // The main thread already made room for every outstanding request, so the results never grow here. The only thing
+                // this thread allocates is its profiler buffer on the first zone, which goes through the locked allocator
+                SDL_LockMutex(glyph_queue_mutex);
+                glyph_results[glyph_result_count++] = result;
+        }
+
+        SDL_UnlockMutex(glyph_queue_mutex);
+        return 0;
+}
+
+static bool start_glyph_worker(void) {
+        if (glyph_worker) {
+                return true;
+        }
+
+        if (glyph_worker_failed) {
+                return false;
+        }
+
+        if (!(glyph_queue_mutex = SDL_CreateMutex())) {
+                send_message(MESSAGE_ERROR, "Failed to start glyph worker: Failed to create mutex: %s", SDL_GetMESSAGE_ERROR());
+                glyph_worker_failed = true;
+                return false;
+        }
+
+        if (!(glyph_queue_condition = SDL_CreateCond())) {
+                send_message(MESSAGE_ERROR, "Failed to start glyph worker: Failed to create condition: %s", SDL_GetMESSAGE_ERROR());
+                SDL_DestroyMutex(glyph_queue_mutex);
+                glyph_queue_mutex = NULL;
+                glyph_worker_failed = true;
+                return false;
+        }
+
+        glyph_worker_quitting = false;
+        if (!(glyph_worker = SDL_CreateThread(run_glyph_worker, "Glyphs", NULL))) {
+                send_message(MESSAGE_ERROR, "Failed to start glyph worker: Failed to create thread: %s", SDL_GetMESSAGE_ERROR());
+                SDL_DestroyCond(glyph_queue_condition);
+                SDL_DestroyMutex(glyph_queue_mutex);
+                glyph_queue_condition = NULL;
+                glyph_queue_mutex = NULL;
+                glyph_worker_failed = true;
+                return false;
+        }
+
+        return true;
+}
+
+static void stop_glyph_worker(void) {
+        if (!glyph_worker) {
+                return;
+        }
+
+        SDL_LockMutex(glyph_queue_mutex);
+        glyph_worker_quitting = true;
+        SDL_CondSignal(glyph_queue_condition);
+        SDL_UnlockMutex(glyph_queue_mutex);
+        SDL_WaitThread(glyph_worker, NULL);
+        glyph_worker = NULL;
+
+        for (size_t result_index = 0ULL; result_index < glyph_result_count; ++result_index) {
+                SDL_FreeSurface(glyph_results[result_index].surface);
+        }
+
+        if (glyph_requests) {
+                xfree(glyph_requests);
+        }
+
+        if (glyph_results) {
+                xfree(glyph_results);
+        }
+
+        if (drained_results) {
+                xfree(drained_results);
+        }
+
+        glyph_requests = NULL;
+        glyph_request_head = 0ULL;
+        glyph_request_count = 0ULL;
+        glyph_request_capacity = 0ULL;
+        glyph_results = NULL;
+        glyph_result_count = 0ULL;
+        glyph_result_capacity = 0ULL;
+        outstanding_glyph_count = 0ULL;
+        drained_results = NULL;
+        drained_result_capacity = 0ULL;
+
+        for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
+                if (worker_fonts[font_index]) {
+                        TTF_CloseFont(worker_fonts[font_index]);
+                        worker_fonts[font_index] = NULL;
+                }
+        }
+
+        SDL_DestroyCond(glyph_queue_condition);
+        SDL_DestroyMutex(glyph_queue_mutex);
+        glyph_queue_condition = NULL;
+        glyph_queue_mutex = NULL;
+}
+
+bool request_glyph(const enum Font font, const uint32_t codepoint, struct Glyph *const out_glyph) {
+        struct GlyphAtlas *const atlas = &atlases[font];
+        if (!atlas->surface && !initialize_glyph_atlas(atlas)) {
+                return false;
+        }
+
+        const struct GlyphEntry *const entry = find_glyph_entry(atlas, codepoint);
+        if (entry->codepoint == codepoint) {
+                if (entry->pending) {
+                        return false;
+                }
+
+                *out_glyph = entry->glyph;
+                return true;
+        }
+
+        if (!start_glyph_worker()) {
+                return get_glyph(font, codepoint, out_glyph);
+        }
+
+        // Instances are opened here on the main thread, FreeType doesn't allow opening faces concurrently
+        if (!worker_fonts[font] && !(worker_fonts[font] = open_font_instance(font))) {
+                return get_glyph(font, codepoint, out_glyph);
+        }
+
+        const struct Glyph empty_glyph = (struct Glyph){ 0 };
+        insert_glyph_entry(atlas, codepoint, &empty_glyph);
+        find_glyph_entry(atlas, codepoint)->pending = true;
+
+        SDL_LockMutex(glyph_queue_mutex);
+        if (glyph_request_count == glyph_request_capacity) {
+                glyph_request_capacity = glyph_request_capacity ? glyph_request_capacity * 2ULL : 64ULL;
+                glyph_requests = (struct GlyphRequest *)xrealloc(glyph_requests, sizeof(struct GlyphRequest) * glyph_request_capacity);
+        }
+
+        if (++outstanding_glyph_count > glyph_result_capacity) {
+                glyph_result_capacity = MAXIMUM_VALUE(outstanding_glyph_count, glyph_result_capacity * 2ULL);
+                glyph_results = (struct GlyphResult *)xrealloc(glyph_results, sizeof(struct GlyphResult) * glyph_result_capacity);
+        }
+
+        glyph_requests[glyph_request_count++] = (struct GlyphRequest){ .font = font, .instance = worker_fonts[font], .codepoint = codepoint };
+        SDL_CondSignal(glyph_queue_condition);
+        SDL_UnlockMutex(glyph_queue_mutex);
+        return false;
+}
+
+void update_glyph_atlases(void) {
+        if (!glyph_worker) {
+                return;
+        }
+
+        SDL_LockMutex(glyph_queue_mutex);
+        const size_t result_count = glyph_result_count;
+        if (!result_count) {
+                SDL_UnlockMutex(glyph_queue_mutex);
+                return;
+        }
+
+        if (result_count > drained_result_capacity) {
+                drained_result_capacity = MAXIMUM_VALUE(result_count, drained_result_capacity * 2ULL);
+                drained_results = (struct GlyphResult *)xrealloc(drained_results, sizeof(struct GlyphResult) * drained_result_capacity);
+        }
+
+        memcpy(drained_results, glyph_results, sizeof(struct GlyphResult) * result_count);
+        glyph_result_count = 0ULL;
+        outstanding_glyph_count -= result_count;
+        SDL_UnlockMutex(glyph_queue_mutex);
+
+        // Packing and blitting stay on the main thread, they're cheap next to rasterizing and the atlas isn't shared
+        for (size_t result_index = 0ULL; result_index < result_count; ++result_index) {
+                struct GlyphResult *const result = &drained_results[result_index];
+                struct GlyphAtlas *const atlas = &atlases[result->font];
+                struct GlyphEntry *const entry = find_glyph_entry(atlas, result->codepoint);
+                ++atlas_generations[result->font];
+
+                if (entry->codepoint != result->codepoint || !entry->pending) {
+                        SDL_FreeSurface(result->surface);
+                        continue;
+                }
+
+                struct Glyph glyph;
+                if (!result->provided) {
+                        if (!get_glyph(result->font, FALLBACK_CODEPOINT, &glyph)) {
+                                glyph = (struct Glyph){ 0 };
+                        }
+                } else if (!result->rasterized) {
+                        send_message(MESSAGE_ERROR, "Failed to rasterize glyph U+%04X on the worker thread", (unsigned int)result->codepoint);
+                        glyph = (struct Glyph){ 0 };
+                } else {
+                        glyph = result->glyph;
+                        if (!place_glyph(atlas, result->surface, &glyph)) {
+                                send_message(MESSAGE_ERROR, "Failed to rasterize glyph U+%04X: Failed to find room in the atlas", (unsigned int)result->codepoint);
+                                glyph = (struct Glyph){ 0 };
+                        }
+                }
+
+                SDL_FreeSurface(result->surface);
+
+                // The insertion for the fallback may have moved the entries around
+                struct GlyphEntry *const resolved_entry = find_glyph_entry(atlas, result->codepoint);
+                resolved_entry->glyph = glyph;
+                resolved_entry->pending = false;
+        }
+}
+
+size_t get_glyph_atlas_generation(const enum Font font) {
+        return atlas_generations[font];
+}
+
+int get_glyph_kerning(const enum Font font, const uint32_t previous_codepoint, const uint32_t codepoint) {
+        TTF_Font *const ttf_font = get_font(font);
+        if (!TTF_GetFontKerning(ttf_font)) {
+                return 0;
+        }
+
+        return TTF_GetFontKerningSizeGlyphs32(ttf_font, previous_codepoint, codepoint);
+}
+
+int get_glyph_line_height(const enum Font font) {
+        return TTF_FontHeight(get_font(font));
+}
+
+SDL_Texture *get_glyph_atlas_texture(const enum Font font, int *const out_width, int *const out_height) {
+        struct GlyphAtlas *const atlas = &atlases[font];
+        if (!atlas->surface) {
+                return NULL;
+        }
+
+        if (!atlas->texture) {
+                if (!(atlas->texture = create_frame_texture(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, atlas->surface->w, atlas->surface->h, SDL_BLENDMODE_BLEND))) {
+                        send_message(MESSAGE_ERROR, "Failed to get glyph atlas texture: Failed to create texture: %s", SDL_GetMESSAGE_ERROR());
+                        return NULL;
+                }
+
+                update_frame_texture(atlas->texture, NULL, atlas->surface->pixels, atlas->surface->pitch);
+                atlas->dirty = false;
+        } else if (atlas->dirty) {
+                // Only the new glyphs are copied into the frame being recorded, the texture picks them up when that frame is replayed
+                // and doesn't hold the simulation up in the meantime
+                const SDL_Rect *const rectangle = &atlas->dirty_rectangle;
+                const Uint8 *const pixels = (const Uint8 *)atlas->surface->pixels + rectangle->y * atlas->surface->pitch + rectangle->x * 4;
+                update_frame_texture(atlas->texture, rectangle, pixels, atlas->surface->pitch);
+                atlas->dirty = false;
+        }
+
+        if (out_width != NULL) {
+                *out_width = atlas->surface->w;
+        }
+
+        if (out_height != NULL) {
+                *out_height = atlas->surface->h;
+        }
+
+        return atlas->texture;
+}
+
+void terminate_glyph_atlases(void) {
+        stop_glyph_worker();
+        save_glyph_cache();
+
+        for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
+                struct GlyphAtlas *const atlas = &atlases[font_index];
+                if (!atlas->surface) {
+                        continue;
+                }
+
+                if (atlas->texture) {
+                        destroy_frame_texture(atlas->texture);
+                }
+
+                discard_glyph_atlas(atlas);
+        }
+}
+
+// ================================================================================================
+// Cache
+// ================================================================================================
+
+#define GLYPH_CACHE_FILE_NAME "glyphs.cache"
+#define GLYPH_CACHE_MAGIC     "SKBGLYPH"
+#define GLYPH_CACHE_VERSION   1U
+
+struct GlyphCacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t font_count;
+};
+
+// An atlas is only reused when it was rasterized from the same font file, at the same size and the same display scale
+struct GlyphCacheKey {
+        uint64_t file_hash;
+        int32_t point_size;
+        float scale;
+};
+
+struct GlyphCacheSection {
+        struct GlyphCacheKey key;
+        int32_t atlas_size;
+        int32_t shelf_x;
+        int32_t shelf_y;
+        int32_t shelf_height;
+        uint32_t glyph_count;
+};
+
+struct GlyphCacheGlyph {
+        uint32_t codepoint;
+        int32_t atlas_x;
+        int32_t atlas_y;
+        int32_t width;
+        int32_t height;
+        int32_t offset_x;
+        int32_t advance;
+};
+
+static bool glyph_cache_keys_ready = false;
+static struct GlyphCacheKey glyph_cache_keys[FONT_COUNT];
+
+static bool hash_font_file(const char *const path, uint64_t *const out_hash) {
+        FILE *const file = fopen(path, "rb");
+        if (file == NULL) {
+                send_message(MESSAGE_ERROR, "Failed to hash font file \"%s\": %s", path, strMESSAGE_ERROR(errno));
+                return false;
+        }
+
+        // FNV-1a, it only has to tell font files apart
+        uint64_t hash = 14695981039346656037ULL;
+        unsigned char buffer[4096];
+        size_t read_size;
+        while ((read_size = fread(buffer, 1ULL, sizeof(buffer), file)) > 0ULL) {
+                for (size_t byte_index = 0ULL; byte_index < read_size; ++byte_index) {
+                        hash = (hash ^ buffer[byte_index]) * 1099511628211ULL;
+                }
+        }
+
+        fclose(file);
+        *out_hash = hash;
+        return true;
+}
+
+static bool prepare_glyph_cache_keys(void) {
+        if (glyph_cache_keys_ready) {
+                return true;
+        }
+
+        for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
+                const char *const path = get_font_path((enum Font)font_index);
+
+                // Several fonts share the same file, which then only has to be hashed once
+                bool hashed = false;
+                for (size_t previous_index = 0ULL; previous_index < font_index; ++previous_index) {
+                        if (!strcmp(path, get_font_path((enum Font)previous_index))) {
+                                glyph_cache_keys[font_index].file_hash = glyph_cache_keys[previous_index].file_hash;
+                                hashed = true;
+                                break;
+                        }
+                }
+
+                if (!hashed && !hash_font_file(path, &glyph_cache_keys[font_index].file_hash)) {
+                        return false;
+                }
+
+                glyph_cache_keys[font_index].point_size = (int32_t)get_font_point_size((enum Font)font_index);
+                glyph_cache_keys[font_index].scale = get_font_scale();
+        }
+
+        glyph_cache_keys_ready = true;
+        return true;
+}
+
+static bool get_glyph_cache_path(char *const path, const size_t size) {
+        const char *const directory_path = get_persistent_directory_path();
+        if (!*directory_path) {
+                return false;
+        }
+
+        snprintf(path, size, "%s%s", directory_path, GLYPH_CACHE_FILE_NAME);
+        return true;
+}
+
+static bool read_glyph_cache_data(const unsigned char **const position, const unsigned char *const end, void *const data, const size_t size) {
+        if ((size_t)(end - *position) < size) {
+                return false;
+        }
+
+        memcpy(data, *position, size);
+        *position += size;
+        return true;
+}
+
+static bool is_cached_glyph_valid(const struct GlyphCacheGlyph *const cached_glyph, const int32_t atlas_size) {
+        if (cached_glyph->codepoint == EMPTY_CODEPOINT) {
+                return false;
+        }
+
+        if (cached_glyph->atlas_x < 0 || cached_glyph->atlas_y < 0 || cached_glyph->width < 0 || cached_glyph->height < 0) {
+                return false;
+        }
+
+        return (int64_t)cached_glyph->atlas_x + cached_glyph->width <= atlas_size && (int64_t)cached_glyph->atlas_y + cached_glyph->height <= atlas_size;
+}
+
+static bool load_glyph_atlas(struct GlyphAtlas *const atlas, const struct GlyphCacheSection *const section, const unsigned char **const position, const unsigned char *const end) {
+        const size_t glyphs_size = sizeof(struct GlyphCacheGlyph) * (size_t)section->glyph_count;
+        const size_t pixels_size = (size_t)section->atlas_size * (size_t)section->atlas_size * 4ULL;
+        if ((size_t)(end - *position) < glyphs_size + pixels_size) {
+                return false;
+        }
+
+        const int32_t atlas_size = section->atlas_size;
+        if (section->shelf_x < 0 || section->shelf_x > atlas_size || section->shelf_y < 0 || section->shelf_height < 0 || (int64_t)section->shelf_y + section->shelf_height > atlas_size) {
+                send_message(MESSAGE_WARNING, "Failed to load glyph atlas: The packing shelf lies outside of the atlas");
+                return false;
+        }
+
+        if (!initialize_glyph_atlas(atlas)) {
+                return false;
+        }
+
+        SDL_Surface *const surface = SDL_CreateRGBSurfaceWithFormat(0, section->atlas_size, section->atlas_size, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!surface) {
+                send_message(MESSAGE_ERROR, "Failed to load glyph atlas: Failed to create surface: %s", SDL_GetMESSAGE_ERROR());
+                return false;
+        }
+
+        SDL_FreeSurface(atlas->surface);
+        atlas->surface = surface;
+        atlas->shelf_x = section->shelf_x;
+        atlas->shelf_y = section->shelf_y;
+        atlas->shelf_height = section->shelf_height;
+
+        for (uint32_t glyph_index = 0U; glyph_index < section->glyph_count; ++glyph_index) {
+                struct GlyphCacheGlyph cached_glyph;
+                read_glyph_cache_data(position, end, &cached_glyph, sizeof(cached_glyph));
+
+                // A record that would corrupt the table or sample outside of the atlas throws out the whole atlas
+                if (!is_cached_glyph_valid(&cached_glyph, atlas_size) || find_glyph_entry(atlas, cached_glyph.codepoint)->codepoint == cached_glyph.codepoint) {
+                        send_message(MESSAGE_WARNING, "Failed to load glyph atlas: The record of codepoint %u is invalid or duplicated", (unsigned int)cached_glyph.codepoint);
+                        discard_glyph_atlas(atlas);
+                        return false;
+                }
+
+                const struct Glyph glyph = (struct Glyph){
+                        .atlas_x = cached_glyph.atlas_x,
+                        .atlas_y = cached_glyph.atlas_y,
+                        .width = cached_glyph.width,
+                        .height = cached_glyph.height,
+                        .offset_x = cached_glyph.offset_x,
+                        .advance = cached_glyph.advance
+                };
+
+                insert_glyph_entry(atlas, cached_glyph.codepoint, &glyph);
+        }
+
+        const size_t row_size = (size_t)section->atlas_size * 4ULL;
+        for (int row = 0; row < section->atlas_size; ++row) {
+                memcpy((unsigned char *)surface->pixels + row * surface->pitch, *position, row_size);
+                *position += row_size;
+        }
+
+        atlas->modified = false;
+        return true;
+}
+
+bool load_glyph_cache(void) {
+        if (!prepare_glyph_cache_keys()) {
+                send_message(MESSAGE_ERROR, "Failed to load glyph cache: Failed to hash the font files");
+                return false;
+        }
+
+        char path[1024];
+        if (!get_glyph_cache_path(path, sizeof(path))) {
+                return false;
+        }
+
+        FILE *const file = fopen(path, "rb");
+        if (file == NULL) {
+                send_message(MESSAGE_INFORMATION, "No glyph cache at \"%s\", glyphs will be rasterized", path);
+                return false;
+        }
+
+        if (fseek(file, 0L, SEEK_END)) {
+                send_message(MESSAGE_WARNING, "Ignoring glyph cache \"%s\": Failed to seek: %s", path, strMESSAGE_ERROR(errno));
+                fclose(file);
+                return false;
+        }
+
+        // A damaged cache only costs the glyphs being rasterized again, so it's rejected before anything gets allocated for it
+        const long length = ftell(file);
+        if (length < 0L || (unsigned long)length < (unsigned long)sizeof(struct GlyphCacheHeader)) {
+                send_message(MESSAGE_WARNING, "Ignoring glyph cache \"%s\": File is truncated or unreadable", path);
+                fclose(file);
+                return false;
+        }
+
+        const size_t size = (size_t)length;
+        rewind(file);
+
+        // The whole cache is read at once, every atlas is then copied straight out of the buffer
+        unsigned char *const data = (unsigned char *)xmalloc(size);
+        if (fread(data, 1ULL, size, file) != size) {
+                send_message(MESSAGE_ERROR, "Failed to load glyph cache: Failed to read \"%s\": %s", path, strMESSAGE_ERROR(errno));
+                xfree(data);
+                fclose(file);
+                return false;
+        }
+
+        fclose(file);
+
+        const unsigned char *position = data;
+        const unsigned char *const end = data + size;
+
+        struct GlyphCacheHeader header;
+        if (!read_glyph_cache_data(&position, end, &header, sizeof(header)) || memcmp(header.magic, GLYPH_CACHE_MAGIC, sizeof(header.magic)) || header.version != GLYPH_CACHE_VERSION || header.font_count != FONT_COUNT) {
+                send_message(MESSAGE_WARNING, "Ignoring glyph cache \"%s\": Unrecognized format", path);
+                xfree(data);
+                return false;
+        }
+
+        size_t loaded_count = 0ULL;
+        for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
+                struct GlyphCacheSection section;
+                if (!read_glyph_cache_data(&position, end, &section, sizeof(section))) {
+                        send_message(MESSAGE_WARNING, "Ignoring the rest of glyph cache \"%s\": File is truncated", path);
+                        break;
+                }
+
+                const size_t section_size = sizeof(struct GlyphCacheGlyph) * (size_t)section.glyph_count + (size_t)section.atlas_size * (size_t)section.atlas_size * 4ULL;
+                const struct GlyphCacheKey *const key = &glyph_cache_keys[font_index];
+                const bool matching = section.key.file_hash == key->file_hash && section.key.point_size == key->point_size && section.key.scale == key->scale;
+                if (!matching || section.atlas_size <= 0 || section.atlas_size > MAXIMUM_ATLAS_SIZE || atlases[font_index].surface) {
+                        if ((size_t)(end - position) < section_size) {
+                                break;
+                        }
+
+                        position += section_size;
+                        continue;
+                }
+
+                if (!load_glyph_atlas(&atlases[font_index], &section, &position, end)) {
+                        send_message(MESSAGE_WARNING, "Ignoring the rest of glyph cache \"%s\": Failed to load the atlas of font %zu", path, font_index);
+                        break;
+                }
+
+                ++loaded_count;
+        }
+
+        xfree(data);
+        send_message(MESSAGE_INFORMATION, "Loaded %zu glyph atlases from \"%s\"", loaded_count, path);
+        return true;
+}
+
+static void write_glyph_atlas(FILE *const file, const size_t font_index) {
+        const struct GlyphAtlas *const atlas = &atlases[font_index];
+
+        size_t glyph_count = 0ULL;
+        if (atlas->surface) {
+                for (size_t entry_index = 0ULL; entry_index < atlas->entry_capacity; ++entry_index) {
+                        if (atlas->entries[entry_index].codepoint != EMPTY_CODEPOINT && !atlas->entries[entry_index].pending) {
+                                ++glyph_count;
+                        }
+                }
+        }
+
+        const struct GlyphCacheSection section = (struct GlyphCacheSection){
+                .key = glyph_cache_keys[font_index],
+                .atlas_size = atlas->surface ? atlas->surface->w : 0,
+                .shelf_x = atlas->shelf_x,
+                .shelf_y = atlas->shelf_y,
+                .shelf_height = atlas->shelf_height,
+                .glyph_count = (uint32_t)glyph_count
+        };
+
+        fwrite(&section, sizeof(section), 1ULL, file);
+        if (!atlas->surface) {
+                return;
+        }
+
+        for (size_t entry_index = 0ULL; entry_index < atlas->entry_capacity; ++entry_index) {
+                const struct GlyphEntry *const entry = &atlas->entries[entry_index];
+                if (entry->codepoint == EMPTY_CODEPOINT || entry->pending) {
+                        continue;
+                }
+
+                const struct GlyphCacheGlyph cached_glyph = (struct GlyphCacheGlyph){
+                        .codepoint = entry->codepoint,
+                        .atlas_x = entry->glyph.atlas_x,
+                        .atlas_y = entry->glyph.atlas_y,
+                        .width = entry->glyph.width,
+                        .height = entry->glyph.height,
+                        .offset_x = entry->glyph.offset_x,
+                        .advance = entry->glyph.advance
+                };
+
+                fwrite(&cached_glyph, sizeof(cached_glyph), 1ULL, file);
+        }
+
+        const size_t row_size = (size_t)atlas->surface->w * 4ULL;
+        for (int row = 0; row < atlas->surface->h; ++row) {
+                fwrite((const unsigned char *)atlas->surface->pixels + row * atlas->surface->pitch, 1ULL, row_size, file);
+        }
+}
+
+bool save_glyph_cache(void) {
+        bool modified = false;
+        for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
+                modified = modified || atlases[font_index].modified;
+        }
+
+        if (!modified || !glyph_cache_keys_ready) {
+                return true;
+        }
+
+        char path[1024];
+        char temporary_path[1040];
+        if (!get_glyph_cache_path(path, sizeof(path))) {
+                return false;
+        }
+
+        // Written next to the cache and moved over it, so an interrupted save never leaves a broken cache behind
+        snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", path);
+        FILE *const file = fopen(temporary_path, "wb");
+        if (file == NULL) {
+                send_message(MESSAGE_ERROR, "Failed to save glyph cache: Failed to open \"%s\": %s", temporary_path, strMESSAGE_ERROR(errno));
+                return false;
+        }
+
+        struct GlyphCacheHeader header = (struct GlyphCacheHeader){ .version = GLYPH_CACHE_VERSION, .font_count = (uint32_t)FONT_COUNT };
+        memcpy(header.magic, GLYPH_CACHE_MAGIC, sizeof(header.magic));
+        fwrite(&header, sizeof(header), 1ULL, file);
+
+        for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
+                write_glyph_atlas(file, font_index);
+        }
+
+        const bool written = !ferror(file);
+        fclose(file);
+
+        remove(path);
+        if (!written || rename(temporary_path, path) != 0) {
+                send_message(MESSAGE_ERROR, "Failed to save glyph cache: Failed to write \"%s\": %s", path, strMESSAGE_ERROR(errno));
+                remove(temporary_path);
+                return false;
+        }
+
+        for (size_t font_index = 0ULL; font_index < FONT_COUNT; ++font_index) {
+                atlases[font_index].modified = false;
+        }
+
+        return true;
+}
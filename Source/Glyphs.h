@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "Assets.h"
+
+typedef struct SDL_Texture SDL_Texture;
+
+struct Glyph {
+        int atlas_x;
+        int atlas_y;
+        int width;
+        int height;
+        int offset_x;
+        int advance;
+};
+
+bool get_glyph(const enum Font font, const uint32_t codepoint, struct Glyph *const out_glyph);
+
+bool request_glyph(const enum Font font, const uint32_t codepoint, struct Glyph *const out_glyph);
+
+void update_glyph_atlases(void);
+
+size_t get_glyph_atlas_generation(const enum Font font);
+
+int get_glyph_kerning(const enum Font font, const uint32_t previous_codepoint, const uint32_t codepoint);
+
+int get_glyph_line_height(const enum Font font);
+
+SDL_Texture *get_glyph_atlas_texture(const enum Font font, int *const out_width, int *const out_height);
+
+bool load_glyph_cache(void);
+
+bool save_glyph_cache(void);
+
+void terminate_glyph_atlases(void);
@@ -4,6 +4,7 @@
 
 #include "Geometry.h"
 #include "Utilities.h"
+#include "Jobs.h"
 
 struct Icon {
         enum IconType type;
@@ -12,7 +13,10 @@ struct Icon {
         float x;
         float y;
         struct Geometry *geometry;
+        struct JobBatch tessellation;
         bool outdated_geometry;
+        float geometry_x;
+        float geometry_y;
 };
 
 static void write_play_icon_geometry(struct Icon *);
@@ -48,8 +52,11 @@ struct Icon *create_icon(const enum IconType type) {
 
         icon->geometry = create_geometry();
         set_geometry_color(icon->geometry, COLOR_BROWN, COLOR_OPAQUE);
+        SDL_AtomicSet(&icon->tessellation.remaining_jobs, 0);
 
         icon->outdated_geometry = true;
+        icon->geometry_x = 0.0f;
+        icon->geometry_y = 0.0f;
         return icon;
 }
 
@@ -59,16 +66,31 @@ void destroy_icon(struct Icon *const icon) {
                 return;
         }
 
+        wait_for_job_batch(&icon->tessellation);
         destroy_geometry(icon->geometry);
         xfree(icon);
 }
 
+static void write_icon_geometry(void *const data) {
+        struct Icon *const icon = (struct Icon *)data;
+        icon_geometry_writers[icon->type](icon);
+}
+
 void update_icon(struct Icon *const icon) {
         if (icon->outdated_geometry) {
-                icon_geometry_writers[icon->type](icon);
+                submit_job(&icon->tessellation, "write_icon_geometry", write_icon_geometry, icon);
                 icon->outdated_geometry = false;
+        } else if (icon->geometry_x != icon->x || icon->geometry_y != icon->y) {
+                // Every icon is written relative to its position, so moving it doesn't need it to be written again
+                translate_geometry(icon->geometry, icon->x - icon->geometry_x, icon->y - icon->geometry_y);
         }
 
+        icon->geometry_x = icon->x;
+        icon->geometry_y = icon->y;
+}
+
+void render_icon(struct Icon *const icon) {
+        wait_for_job_batch(&icon->tessellation);
         render_geometry(icon->geometry);
 }
 
@@ -91,13 +113,8 @@ void set_icon_size(struct Icon *const icon, const float size) {
 }
 
 void set_icon_position(struct Icon *const icon, const float x, const float y) {
-        if (icon->x == x && icon->y == y) {
-                return;
-        }
-
         icon->x = x;
         icon->y = y;
-        icon->outdated_geometry = true;
 }
 
 void set_icon_rotation(struct Icon *const icon, const float rotation) {
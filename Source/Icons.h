@@ -23,6 +23,8 @@ void destroy_icon(struct Icon *const icon);
 
 void update_icon(struct Icon *const icon);
 
+void render_icon(struct Icon *const icon);
+
 void set_icon_type(struct Icon *const icon, const enum IconType type);
 
 void set_icon_size(struct Icon *const icon, const float size);
@@ -0,0 +1,253 @@
+#include "Jobs.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "SDL.h"
+
+#include "Utilities.h"
+#include "Profiler.h"
+
+#define JOB_WORKER_LIMIT   7ULL
+#define JOB_QUEUE_CAPACITY 256ULL
+
+struct Job {
+        const char *name;
+        void (*function)(void *);
+        void *data;
+        struct JobBatch *batch;
+};
+
+// Every worker owns a queue that the simulation deals jobs into. A worker takes the newest job of its own queue first, and once
+// it runs dry it steals the oldest job of the other queues, so a frame with a few heavy jobs still ends up spread over every core.
+struct JobQueue {
+        SDL_SpinLock lock;
+        size_t top;
+        size_t bottom;
+        struct Job jobs[JOB_QUEUE_CAPACITY];
+};
+
+static struct JobQueue job_queues[JOB_WORKER_LIMIT];
+static SDL_Thread *job_workers[JOB_WORKER_LIMIT];
+static size_t job_worker_count = 0ULL;
+static size_t next_job_queue_index = 0ULL;
+
+static SDL_atomic_t queued_job_count;
+static SDL_mutex *job_mutex = NULL;
+static SDL_cond *job_condition = NULL;
+static SDL_cond *job_batch_condition = NULL;
+static bool job_workers_quitting = false;
+
+static bool pop_job(struct JobQueue *const queue, struct Job *const out_job) {
+        SDL_AtomicLock(&queue->lock);
+        if (queue->top == queue->bottom) {
+                SDL_AtomicUnlock(&queue->lock);
+                return false;
+        }
+
+        --queue->bottom;
+        *out_job = queue->jobs[queue->bottom % JOB_QUEUE_CAPACITY];
+        SDL_AtomicUnlock(&queue->lock);
+        return true;
+}
+
+static bool steal_job(struct JobQueue *const queue, struct Job *const out_job) {
+        SDL_AtomicLock(&queue->lock);
+        if (queue->top == queue->bottom) {
+                SDL_AtomicUnlock(&queue->lock);
+                return false;
+        }
+
+        *out_job = queue->jobs[queue->top % JOB_QUEUE_CAPACITY];
+        ++queue->top;
+        SDL_AtomicUnlock(&queue->lock);
+        return true;
+}
+
+static bool take_job(const size_t queue_index, const bool owner, struct Job *const out_job) {
+        if (owner && pop_job(&job_queues[queue_index], out_job)) {
+                SDL_AtomicAdd(&queued_job_count, -1);
+                return true;
+        }
+
+        for (size_t offset = owner ? 1ULL : 0ULL; offset < job_worker_count; ++offset) {
+                if (steal_job(&job_queues[(queue_index + offset) % job_worker_count], out_job)) {
+                        SDL_AtomicAdd(&queued_job_count, -1);
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+static void run_job(const struct Job *const job) {
+        PROFILE_SCOPE(job->name) {
+                job->function(job->data);
+        }
+
+        if (SDL_AtomicAdd(&job->batch->remaining_jobs, -1) == 1) {
+                SDL_LockMutex(job_mutex);
+                SDL_CondBroadcast(job_batch_condition);
+                SDL_UnlockMutex(job_mutex);
+        }
+}
+
+static int run_job_worker(void *const data) {
+        const size_t queue_index = (size_t)(uintptr_t)data;
+
+        while (true) {
+                struct Job job;
+                if (take_job(queue_index, true, &job)) {
+                        run_job(&job);
+                        continue;
+                }
+
+                SDL_LockMutex(job_mutex);
+                while (!job_workers_quitting && SDL_AtomicGet(&queued_job_count) == 0) {
+                        SDL_CondWait(job_condition, job_mutex);
+                }
+
+                const bool quitting = job_workers_quitting && SDL_AtomicGet(&queued_job_count) == 0;
+                SDL_UnlockMutex(job_mutex);
+
+                if (quitting) {
+                        return 0;
+                }
+        }
+}
+
+void initialize_job_system(void) {
+        SDL_AtomicSet(&queued_job_count, 0);
+        job_workers_quitting = false;
+        next_job_queue_index = 0ULL;
+
+        // The simulation thread helps out while it waits, so one core is left for it
+        const int cpu_count = SDL_GetCPUCount();
+        const size_t wanted_worker_count = cpu_count > 1 ? MINIMUM_VALUE((size_t)cpu_count - 1ULL, JOB_WORKER_LIMIT) : 0ULL;
+        if (wanted_worker_count == 0ULL) {
+                return;
+        }
+
+        job_mutex = SDL_CreateMutex();
+        job_condition = SDL_CreateCond();
+        job_batch_condition = SDL_CreateCond();
+        if (!job_mutex || !job_condition || !job_batch_condition) {
+                send_message(MESSAGE_ERROR, "Failed to start job workers: %s", SDL_GetMESSAGE_ERROR());
+                terminate_job_system();
+                return;
+        }
+
+        for (size_t worker_index = 0ULL; worker_index < wanted_worker_count; ++worker_index) {
+                job_queues[worker_index].top = 0ULL;
+                job_queues[worker_index].bottom = 0ULL;
+        }
+
+        // Workers only steal from the queues below job_worker_count, so it is raised once every queue is ready
+        job_worker_count = wanted_worker_count;
+        for (size_t worker_index = 0ULL; worker_index < wanted_worker_count; ++worker_index) {
+                if (!(job_workers[worker_index] = SDL_CreateThread(run_job_worker, "Jobs", (void *)(uintptr_t)worker_index))) {
+                        send_message(MESSAGE_ERROR, "Failed to start job worker: Failed to create thread: %s", SDL_GetMESSAGE_ERROR());
+                        break;
+                }
+        }
+
+        // Without a single worker, jobs are run right away by whoever submits them
+        if (!job_workers[0]) {
+                terminate_job_system();
+        }
+}
+
+void terminate_job_system(void) {
+        if (job_mutex) {
+                SDL_LockMutex(job_mutex);
+                job_workers_quitting = true;
+                SDL_CondBroadcast(job_condition);
+                SDL_UnlockMutex(job_mutex);
+        }
+
+        for (size_t worker_index = 0ULL; worker_index < JOB_WORKER_LIMIT; ++worker_index) {
+                if (job_workers[worker_index]) {
+                        SDL_WaitThread(job_workers[worker_index], NULL);
+                        job_workers[worker_index] = NULL;
+                }
+        }
+
+        if (job_batch_condition) {
+                SDL_DestroyCond(job_batch_condition);
+                job_batch_condition = NULL;
+        }
+
+        if (job_condition) {
+                SDL_DestroyCond(job_condition);
+                job_condition = NULL;
+        }
+
+        if (job_mutex) {
+                SDL_DestroyMutex(job_mutex);
+                job_mutex = NULL;
+        }
+
+        job_worker_count = 0ULL;
+}
+
+size_t get_job_worker_count(void) {
+        return job_worker_count;
+}
+
+static void run_job_inline(const char *const name, void (*const function)(void *), void *const data) {
+        PROFILE_SCOPE(name) {
+                function(data);
+        }
+}
+
+void submit_job(struct JobBatch *const batch, const char *const name, void (*const function)(void *), void *const data) {
+        if (job_worker_count == 0ULL) {
+                run_job_inline(name, function, data);
+                return;
+        }
+
+        struct JobQueue *const queue = &job_queues[next_job_queue_index];
+        next_job_queue_index = (next_job_queue_index + 1ULL) % job_worker_count;
+
+        SDL_AtomicLock(&queue->lock);
+        if (queue->bottom - queue->top == JOB_QUEUE_CAPACITY) {
+                SDL_AtomicUnlock(&queue->lock);
+                run_job_inline(name, function, data);
+                return;
+        }
+
+        SDL_AtomicAdd(&batch->remaining_jobs, 1);
+        queue->jobs[queue->bottom % JOB_QUEUE_CAPACITY] = (struct Job){
+                .name = name,
+                .function = function,
+                .data = data,
+                .batch = batch
+        };
+
+        ++queue->bottom;
+        SDL_AtomicAdd(&queued_job_count, 1);
+        SDL_AtomicUnlock(&queue->lock);
+
+        SDL_LockMutex(job_mutex);
+        SDL_CondSignal(job_condition);
+        SDL_UnlockMutex(job_mutex);
+}
+
+void wait_for_job_batch(struct JobBatch *const batch) {
+        // Instead of sleeping, the waiting thread runs whatever is still queued, and only blocks once the batch's last jobs are
+        // already running on workers. Nothing gets queued while it waits, since jobs are only ever submitted by the waiting thread.
+        while (SDL_AtomicGet(&batch->remaining_jobs) != 0) {
+                struct Job job;
+                if (take_job(0ULL, false, &job)) {
+                        run_job(&job);
+                        continue;
+                }
+
+                SDL_LockMutex(job_mutex);
+                while (SDL_AtomicGet(&batch->remaining_jobs) != 0 && SDL_AtomicGet(&queued_job_count) == 0) {
+                        SDL_CondWait(job_batch_condition, job_mutex);
+                }
+
+                SDL_UnlockMutex(job_mutex);
+        }
+}
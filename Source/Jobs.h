@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "SDL.h"
+
+struct JobBatch {
+        SDL_atomic_t remaining_jobs;
+};
+
+void initialize_job_system(void);
+
+void terminate_job_system(void);
+
+size_t get_job_worker_count(void);
+
+void submit_job(struct JobBatch *const batch, const char *const name, void (*const function)(void *), void *const data);
+
+void wait_for_job_batch(struct JobBatch *const batch);
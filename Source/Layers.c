@@ -8,6 +8,7 @@
 #include "Context.h"
 #include "Geometry.h"
 #include "Hexagons.h"
+#include "Jobs.h"
 
 #define LAYER_GRID_COLUMNS 10ULL
 #define LAYER_GRID_ROWS 10ULL
@@ -20,8 +21,12 @@ static struct GridMetrics grid_metrics = {};
 static float layers_width = 0.0f;
 static float layers_height = 0.0f;
 
+// The background and its grid never change shape, so they are only written on resize and the grid is rotated as a whole
 static struct Geometry *background_geometry = NULL;
+static struct Geometry *background_grid_geometry = NULL;
+static struct Geometry *rotated_grid_geometry = NULL;
 static struct Geometry *transition_geometry = NULL;
+static struct JobBatch layers_tessellation = {};
 
 #define TRANSITION_DURATION 3000.0f
 static bool transitionning = false;
@@ -34,7 +39,9 @@ static void resize_layers(void);
 
 void initialize_layers(void) {
         background_geometry = create_geometry();
-        transition_geometry = create_geometry();
+        background_grid_geometry = create_geometry();
+        rotated_grid_geometry = create_transient_geometry();
+        transition_geometry = create_transient_geometry();
         grid_metrics.columns = LAYER_GRID_COLUMNS;
         grid_metrics.rows = LAYER_GRID_ROWS;
         grid_rotation = RANDOM_NUMBER(0.0f, ROTATION_CYCLE);
@@ -47,6 +54,12 @@ void terminate_layers(void) {
         destroy_geometry(background_geometry);
         background_geometry = NULL;
 
+        destroy_geometry(background_grid_geometry);
+        background_grid_geometry = NULL;
+
+        destroy_geometry(rotated_grid_geometry);
+        rotated_grid_geometry = NULL;
+
         destroy_geometry(transition_geometry);
         transition_geometry = NULL;
 }
@@ -69,65 +82,76 @@ static inline float transition_easing(const float t) {
         return (3.0f * u * u * t * 0.5f) + (3.0f * u * t * t * 0.5f) + (t * t * t);
 }
 
-void update_layers(const double delta_time) {
-        grid_rotation += ROTATION_SPEED * (float)delta_time / 1000.0f;
-        while (grid_rotation >= ROTATION_CYCLE) {
-                grid_rotation -= ROTATION_CYCLE;
-        }
-
-        if (transitionning) {
-                const float previous_transition_time = transition_time;
-                transition_time += delta_time / TRANSITION_DURATION;
-
-                if (previous_transition_time < 0.5f && transition_time >= 0.5f) {
-                        if (transition_callback) {
-                                transition_callback(transition_callback_data);
-                        }
-
-                        transition_direction = !transition_direction;
-                }
+// Both layers are written by jobs, which only read the state left behind by update_layers()
+static void write_rotated_grid_geometry(void *const data) {
+        const float rotation_pivot_x = grid_metrics.grid_x + grid_metrics.grid_width  / 2.0f;
+        const float rotation_pivot_y = grid_metrics.grid_y + grid_metrics.grid_height / 2.0f;
 
-                if (transition_time >= 1.0f) {
-                        transition_time = 0.0f;
-                        transitionning = false;
-                        return;
-                }
-        }
+        clear_geometry(rotated_grid_geometry);
+        write_rotated_geometry(rotated_grid_geometry, background_grid_geometry, rotation_pivot_x, rotation_pivot_y, grid_rotation);
+}
 
-        clear_geometry(background_geometry);
+static void write_transition_geometry(void *const data) {
         clear_geometry(transition_geometry);
-
-        set_geometry_color(background_geometry, COLOR_DARK_BROWN, COLOR_OPAQUE);
-        write_rectangle_geometry(background_geometry, layers_width / 2.0f, layers_height / 2.0f, layers_width, layers_height, 0.0f);
+        if (!transitionning) {
+                return;
+        }
 
         const float rotation_pivot_x = grid_metrics.grid_x + grid_metrics.grid_width  / 2.0f;
         const float rotation_pivot_y = grid_metrics.grid_y + grid_metrics.grid_height / 2.0f;
 
-        set_geometry_color(background_geometry, COLOR_BROWN, COLOR_OPAQUE);
         const float time = transition_easing(1.0f - fabsf(2.0f * transition_time - 1.0f)) * 2.0f;
         for (size_t row = 0ULL; row < LAYER_GRID_ROWS; ++row) {
                 const size_t row_number = transition_direction ? row + 1ULL : (LAYER_GRID_ROWS - (row + 1ULL));
                 const float row_time = fminf(fmaxf(time - (float)row_number / (float)LAYER_GRID_ROWS, 0.0f), 1.0f);
+                if (row_time == 0.0f) {
+                        continue;
+                }
 
                 for (size_t column = 0ULL; column < LAYER_GRID_COLUMNS; ++column) {
                         float x;
                         float y;
                         get_grid_tile_position(&grid_metrics, column, row, &x, &y);
                         rotate_point(&x, &y, rotation_pivot_x, rotation_pivot_y, grid_rotation);
+                        write_hexagon_geometry(transition_geometry, x, y, grid_metrics.tile_radius * row_time * 2.0f, grid_rotation);
+                }
+        }
+}
+
+void update_layers(const double delta_time) {
+        // Wrapped in one step, fast-forwarded playback can advance the grid by many cycles in a single frame
+        grid_rotation = fmodf(grid_rotation + ROTATION_SPEED * (float)delta_time / 1000.0f, ROTATION_CYCLE);
+
+        if (transitionning) {
+                const float previous_transition_time = transition_time;
+                transition_time += delta_time / TRANSITION_DURATION;
 
-                        write_hexagon_geometry(background_geometry, x, y, grid_metrics.tile_radius * 0.9f, grid_rotation);
-                        if (row_time != 0.0f) {
-                                write_hexagon_geometry(transition_geometry, x, y, grid_metrics.tile_radius * row_time * 2.0f, grid_rotation);
+                if (previous_transition_time < 0.5f && transition_time >= 0.5f) {
+                        if (transition_callback) {
+                                transition_callback(transition_callback_data);
                         }
+
+                        transition_direction = !transition_direction;
+                }
+
+                if (transition_time >= 1.0f) {
+                        transition_time = 0.0f;
+                        transitionning = false;
                 }
         }
+
+        submit_job(&layers_tessellation, "write_rotated_grid_geometry", write_rotated_grid_geometry, NULL);
+        submit_job(&layers_tessellation, "write_transition_geometry", write_transition_geometry, NULL);
 }
 
 void render_background_layer(void) {
+        wait_for_job_batch(&layers_tessellation);
         render_geometry(background_geometry);
+        render_geometry(rotated_grid_geometry);
 }
 
 void render_transition_layer(void) {
+        wait_for_job_batch(&layers_tessellation);
         render_geometry(transition_geometry);
 }
 
@@ -151,7 +175,7 @@ bool trigger_transition_layer(void (*const callback)(void *), void *const callba
 static void resize_layers(void) {
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
 
         layers_width = (float)drawable_width;
         layers_height = (float)drawable_height;
@@ -163,4 +187,20 @@ static void resize_layers(void) {
         grid_metrics.bounding_height = side_length;
 
         populate_grid_metrics_from_size(&grid_metrics);
+
+        clear_geometry(background_geometry);
+        set_geometry_color(background_geometry, COLOR_DARK_BROWN, COLOR_OPAQUE);
+        write_rectangle_geometry(background_geometry, layers_width / 2.0f, layers_height / 2.0f, layers_width, layers_height, 0.0f);
+
+        // Written without any rotation, update_layers() rotates the whole grid around its center every frame
+        clear_geometry(background_grid_geometry);
+        set_geometry_color(background_grid_geometry, COLOR_BROWN, COLOR_OPAQUE);
+        for (size_t row = 0ULL; row < LAYER_GRID_ROWS; ++row) {
+                for (size_t column = 0ULL; column < LAYER_GRID_COLUMNS; ++column) {
+                        float x;
+                        float y;
+                        get_grid_tile_position(&grid_metrics, column, row, &x, &y);
+                        write_hexagon_geometry(background_grid_geometry, x, y, grid_metrics.tile_radius * 0.9f, 0.0f);
+                }
+        }
 }
@@ -10,13 +10,20 @@
 #include "cJSON.h"
 #include "Assets.h"
 #include "Context.h"
+#include "Frame.h"
 #include "Hexagons.h"
 #include "Entity.h"
 #include "Geometry.h"
 #include "Gesture.h"
+#include "Profiler.h"
 
 #define LEVEL_DIMENSION_LIMIT 20
 
+// Rasterizes the static grid into a render target once per resize instead of submitting all of its vertices every frame
+#ifndef CACHE_LEVEL_GRID
+        #define CACHE_LEVEL_GRID 1
+#endif
+
 #define STEP_HISTORY_INITIAL_CAPACITY 64ULL
 
 struct StepHistory {
@@ -179,6 +186,11 @@ struct LevelImplementation {
         struct Entity *current_player;
         struct GridMetrics grid_metrics;
         struct Geometry *grid_geometry;
+        SDL_Texture *grid_texture;
+        SDL_Rect grid_texture_rectangle;
+        bool outdated_grid_texture;
+        int grid_drawable_width;
+        int grid_drawable_height;
         struct StepHistory step_history;
         struct StepHistory undo_history;
         enum Input buffered_input;
@@ -305,6 +317,7 @@ static inline void level_turn_step(struct Level *const level, struct Entity *con
 static bool parse_level(const cJSON *const json, struct Level *const level);
 
 static void resize_level(struct Level *const level);
+static void render_level_grid(struct Level *const level);
 
 struct Level *load_level(const struct LevelMetadata *const metadata) {
         struct Level *const level = (struct Level *)xcalloc(1, sizeof(struct Level));
@@ -337,6 +350,8 @@ bool initialize_level(struct Level *const level, const struct LevelMetadata *con
 
         level->implementation = (struct LevelImplementation *)xmalloc(sizeof(struct LevelImplementation));
         level->implementation->grid_geometry = create_geometry();
+        level->implementation->grid_texture = NULL;
+        level->implementation->outdated_grid_texture = true;
         level->implementation->current_player = NULL;
         level->implementation->has_buffered_input = false;
 
@@ -395,6 +410,10 @@ void deinitialize_level(struct Level *const level) {
 
         destroy_geometry(implementation->grid_geometry);
 
+        if (implementation->grid_texture) {
+                destroy_frame_texture(implementation->grid_texture);
+        }
+
         if (implementation->entities) {
                 for (size_t entity_index = 0ULL; entity_index < implementation->entity_count; ++entity_index) {
                         destroy_entity(implementation->entities[entity_index]);
@@ -467,6 +486,12 @@ bool level_receive_event(struct Level *const level, const SDL_Event *const event
                 return false;
         }
 
+        // The contents of render targets are lost when this happens
+        if (event->type == SDL_RENDER_TARGETS_RESET || event->type == SDL_RENDER_DEVICE_RESET) {
+                level->implementation->outdated_grid_texture = true;
+                return false;
+        }
+
         if (event->type == SDL_KEYDOWN && event->key.repeat == 0) {
                 const SDL_Keycode key = event->key.keysym.sym;
 
@@ -563,20 +588,38 @@ void update_level(struct Level *const level, const double delta_time) {
                 }
         }
 
-        render_geometry(level->implementation->grid_geometry);
+        // Moving the window to a display with a different pixel density changes the drawable size without always resizing. The
+        // resize rewrites every entity, so it has to happen before their tessellation jobs are submitted.
+        int drawable_width;
+        int drawable_height;
+        get_context_drawable_size(&drawable_width, &drawable_height);
+        if (drawable_width != level->implementation->grid_drawable_width || drawable_height != level->implementation->grid_drawable_height) {
+                resize_level(level);
+        }
 
+        // Entities are tessellated in parallel while the grid is drawn, and only handed to the batch once every one of them is done
         for (size_t entity_index = 0ULL; entity_index < level->implementation->entity_count; ++entity_index) {
-                struct Entity *const entity = level->implementation->entities[entity_index];
-                if (get_entity_type(entity) != ENTITY_PLAYER) {
-                        update_entity(entity, delta_time);
-                }
+                update_entity(level->implementation->entities[entity_index], delta_time);
         }
 
-        // Add another pass to update players last (I forgot why though)
-        for (size_t entity_index = 0ULL; entity_index < level->implementation->entity_count; ++entity_index) {
-                struct Entity *const entity = level->implementation->entities[entity_index];
-                if (get_entity_type(entity) == ENTITY_PLAYER) {
-                        update_entity(entity, delta_time);
+        PROFILE_SCOPE("render_level_grid") {
+                render_level_grid(level);
+        }
+
+        PROFILE_SCOPE("render_entities") {
+                for (size_t entity_index = 0ULL; entity_index < level->implementation->entity_count; ++entity_index) {
+                        struct Entity *const entity = level->implementation->entities[entity_index];
+                        if (get_entity_type(entity) != ENTITY_PLAYER) {
+                                render_entity(entity);
+                        }
+                }
+
+                // Add another pass to render players last, so that they are drawn on top of blocks
+                for (size_t entity_index = 0ULL; entity_index < level->implementation->entity_count; ++entity_index) {
+                        struct Entity *const entity = level->implementation->entities[entity_index];
+                        if (get_entity_type(entity) == ENTITY_PLAYER) {
+                                render_entity(entity);
+                        }
                 }
         }
 }
@@ -677,7 +720,11 @@ static void resize_level(struct Level *const level) {
 
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
+
+        implementation->grid_drawable_width = drawable_width;
+        implementation->grid_drawable_height = drawable_height;
+        implementation->outdated_grid_texture = true;
 
         const float grid_padding = fminf((float)drawable_width, (float)drawable_height) / 10.0f;
 
@@ -792,4 +839,91 @@ static void resize_level(struct Level *const level) {
         for (uint16_t entity_index = 0; entity_index < implementation->entity_count; ++entity_index) {
                 resize_entity(implementation->entities[entity_index], implementation->grid_metrics.tile_radius);
         }
-}
\ No newline at end of file
+}
+
+#if CACHE_LEVEL_GRID
+
+static bool cache_level_grid(struct Level *const level) {
+        struct LevelImplementation *const implementation = level->implementation;
+        SDL_Renderer *const renderer = get_context_renderer();
+
+        if (!SDL_RenderTargetSupported(renderer)) {
+                return false;
+        }
+
+        float x;
+        float y;
+        float width;
+        float height;
+        if (!get_geometry_bounds(implementation->grid_geometry, &x, &y, &width, &height)) {
+                return false;
+        }
+
+        // Whole pixels, so the grid lands on exactly the same pixels it would have been rasterized to on screen
+        const int texture_x = (int)floorf(x);
+        const int texture_y = (int)floorf(y);
+        const int texture_width  = (int)ceilf(x + width)  - texture_x;
+        const int texture_height = (int)ceilf(y + height) - texture_y;
+
+        if (
+                implementation->grid_texture &&
+                (implementation->grid_texture_rectangle.w != texture_width || implementation->grid_texture_rectangle.h != texture_height)
+        ) {
+                destroy_frame_texture(implementation->grid_texture);
+                implementation->grid_texture = NULL;
+        }
+
+        if (!implementation->grid_texture) {
+                implementation->grid_texture = create_frame_texture(SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, texture_width, texture_height, SDL_BLENDMODE_BLEND);
+                if (!implementation->grid_texture) {
+                        send_message(MESSAGE_ERROR, "Failed to cache level grid: Failed to create texture: %s", SDL_GetMESSAGE_ERROR());
+                        return false;
+                }
+        }
+
+        implementation->grid_texture_rectangle.x = texture_x;
+        implementation->grid_texture_rectangle.y = texture_y;
+        implementation->grid_texture_rectangle.w = texture_width;
+        implementation->grid_texture_rectangle.h = texture_height;
+
+        // Anything queued so far belongs to the screen, not to the texture
+        flush_geometry_batch();
+
+        SDL_Texture *const previous_target = get_frame_render_target();
+        record_frame_render_target(implementation->grid_texture);
+        record_frame_clear(0, 0, 0, 0);
+
+        translate_geometry(implementation->grid_geometry, (float)-texture_x, (float)-texture_y);
+        render_geometry(implementation->grid_geometry);
+        flush_geometry_batch();
+        translate_geometry(implementation->grid_geometry, (float)texture_x, (float)texture_y);
+
+        record_frame_render_target(previous_target);
+        return true;
+}
+
+#endif
+
+static void render_level_grid(struct Level *const level) {
+        struct LevelImplementation *const implementation = level->implementation;
+
+#if CACHE_LEVEL_GRID
+
+        if (implementation->outdated_grid_texture) {
+                implementation->outdated_grid_texture = false;
+                if (!cache_level_grid(level) && implementation->grid_texture) {
+                        destroy_frame_texture(implementation->grid_texture);
+                        implementation->grid_texture = NULL;
+                }
+        }
+
+        if (implementation->grid_texture) {
+                flush_geometry_batch();
+                record_frame_copy(implementation->grid_texture, &implementation->grid_texture_rectangle, 0.0);
+                return;
+        }
+
+#endif
+
+        render_geometry(implementation->grid_geometry);
+}
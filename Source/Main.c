@@ -1,46 +1,163 @@
 #include <time.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "SDL.h"
 
 #include "Audio.h"
+#include "Animation.h"
 #include "Debug.h"
 #include "Cursor.h"
 #include "Assets.h"
 #include "Layers.h"
 #include "Context.h"
+#include "Frame.h"
+#include "Jobs.h"
 #include "Geometry.h"
+#include "Glyphs.h"
 #include "Persistent.h"
+#include "Profiler.h"
 #include "Scenes.h"
 
 #define WINDOW_MINIMIZED_THROTTLE 100ULL
 
+// Idle frames still come at this interval for the background grid, which rotates too slowly to need more
+#define IDLE_FRAME_INTERVAL 100ULL
+
+#define HEADLESS_DEFAULT_WIDTH  1280
+#define HEADLESS_DEFAULT_HEIGHT  720
+#define HEADLESS_FRAME_DURATION (1000.0 / 60.0)
+
+#define FRAME_PATH_SIZE 4096ULL
+
+#define DEFAULT_FRAME_RATE 60ULL
+#define FRAME_PACER_SPIN_MILLISECONDS 2ULL
+
+// Set from the command line:
+//   --headless            Render offscreen through the software renderer, without any window, audio or display
+//   --size <W>x<H>        Size of the offscreen surface in headless mode
+//   --frames <N>          Exit successfully after N frames
+//   --dump <DIRECTORY>    Save every frame as a BMP image into the directory
+//   --speed <SCALE|max>   Simulation time scale, used to play sessions back faster than they were recorded
+//   --fps <N>             Frame rate cap when vsync is unavailable or disabled, 0 leaves the frame rate uncapped
+//   --no-vsync            Pace frames with the frame rate cap instead of the display
+//   --trace <PATH>        Export the profiled zones as a Chrome trace (chrome://tracing, Perfetto) on exit, debug builds only
+//   --quality <TIER>      Curve tessellation quality, low, medium or high, lower tiers emit fewer vertices for slower machines
+static bool headless = false;
+static int headless_width = HEADLESS_DEFAULT_WIDTH;
+static int headless_height = HEADLESS_DEFAULT_HEIGHT;
+static size_t frame_limit = 0ULL;
+static const char *frame_dump_directory = NULL;
+static size_t frame_index = 0ULL;
+static size_t frame_rate = DEFAULT_FRAME_RATE;
+static bool vsync = true;
+static const char *trace_path = NULL;
+
+// Performance counter value at which the next frame is due, frames are scheduled against it rather than against the end of the
+// previous frame so that a frame that ends late is compensated by a shorter wait on the next one
+static Uint64 next_frame_deadline = 0ULL;
+
+static bool window_minimized = false;
+static bool idle = false;
+
+// Zero after a deliberate wait, so that the time spent idle or minimized isn't counted as a frame
+static Uint64 previous_present_time = 0ULL;
+
+static void parse_arguments(const int argument_count, char *const argument_values[]);
 static void initialize(void);
 static void update(const double delta_time);
+static bool build_frame(const double delta_time);
+static void pace_frame(void);
 static void terminate(const int exit_code);
 
 int main(const int argument_count, char *const argument_values[]) {
         srand((unsigned int)time(NULL));
+        parse_arguments(argument_count, argument_values);
         initialize();
 
         scene_manager_present_scene(SCENE_MAIN_MENU);
 
         Uint64 previous_time = SDL_GetPerformanceCounter();
         while (true) {
+                // Nothing on screen changes on its own while idle or minimized, so the loop blocks until an event arrives or the
+                // interval runs out, leaving the event in the queue for update() to hand to the next frame
+                if (!headless && (window_minimized || idle)) {
+                        SDL_WaitEventTimeout(NULL, (int)(window_minimized ? WINDOW_MINIMIZED_THROTTLE : IDLE_FRAME_INTERVAL));
+                        previous_present_time = 0ULL;
+                }
+
                 const Uint64 current_time = SDL_GetPerformanceCounter();
                 const double delta_time = 1000.0 * (double)(current_time - previous_time) / (double)SDL_GetPerformanceFrequency();
                 previous_time = current_time;
-                update(delta_time);
+
+                // Headless runs advance by a fixed step so that the same run always produces the same frames
+                update(headless ? HEADLESS_FRAME_DURATION : delta_time);
+                pace_frame();
+
+                if (frame_limit != 0ULL && frame_index >= frame_limit) {
+                        terminate(EXIT_SUCCESS);
+                }
         }
 
         return EXIT_FAILURE;
 }
 
+static void parse_arguments(const int argument_count, char *const argument_values[]) {
+        for (int argument_index = 1; argument_index < argument_count; ++argument_index) {
+                const char *const argument = argument_values[argument_index];
+                const bool has_value = argument_index + 1 < argument_count;
+
+                if (!strcmp(argument, "--headless")) {
+                        headless = true;
+                } else if (!strcmp(argument, "--size") && has_value) {
+                        if (sscanf(argument_values[++argument_index], "%dx%d", &headless_width, &headless_height) != 2 || headless_width <= 0 || headless_height <= 0) {
+                                send_message(MESSAGE_WARNING, "Invalid size \"%s\", using %dx%d", argument_values[argument_index], HEADLESS_DEFAULT_WIDTH, HEADLESS_DEFAULT_HEIGHT);
+                                headless_width = HEADLESS_DEFAULT_WIDTH;
+                                headless_height = HEADLESS_DEFAULT_HEIGHT;
+                        }
+                } else if (!strcmp(argument, "--frames") && has_value) {
+                        frame_limit = (size_t)strtoull(argument_values[++argument_index], NULL, 10);
+                } else if (!strcmp(argument, "--dump") && has_value) {
+                        frame_dump_directory = argument_values[++argument_index];
+                } else if (!strcmp(argument, "--fps") && has_value) {
+                        frame_rate = (size_t)strtoull(argument_values[++argument_index], NULL, 10);
+                } else if (!strcmp(argument, "--no-vsync")) {
+                        vsync = false;
+                } else if (!strcmp(argument, "--trace") && has_value) {
+                        trace_path = argument_values[++argument_index];
+                } else if (!strcmp(argument, "--quality") && has_value) {
+                        const char *const quality = argument_values[++argument_index];
+                        if (!strcmp(quality, "low")) {
+                                set_geometry_quality(GEOMETRY_QUALITY_LOW);
+                        } else if (!strcmp(quality, "medium")) {
+                                set_geometry_quality(GEOMETRY_QUALITY_MEDIUM);
+                        } else if (!strcmp(quality, "high")) {
+                                set_geometry_quality(GEOMETRY_QUALITY_HIGH);
+                        } else {
+                                send_message(MESSAGE_WARNING, "Invalid quality \"%s\", using high", quality);
+                        }
+                } else if (!strcmp(argument, "--speed") && has_value) {
+                        const char *const speed = argument_values[++argument_index];
+                        char *speed_end = NULL;
+                        const float time_scale = !strcmp(speed, "max") ? UNBOUNDED_TIME_SCALE : strtof(speed, &speed_end);
+                        if ((speed_end && (speed_end == speed || *speed_end)) || time_scale <= 0.0f) {
+                                send_message(MESSAGE_WARNING, "Invalid speed \"%s\", using 1", speed);
+                        } else {
+                                set_context_time_scale(time_scale);
+                        }
+                } else {
+                        send_message(MESSAGE_WARNING, "Ignoring unknown argument \"%s\"", argument);
+                }
+        }
+}
+
 static void initialize(void) {
-        send_message(MESSAGE_INFORMATION, "Initializing program...");
+        send_message(MESSAGE_INFORMATION, "Initializing program%s...", headless ? " in headless mode" : "");
 
-        if (SDL_Init(SDL_INIT_EVERYTHING) < 0 || TTF_Init() < 0) {
+        const Uint32 subsystems = headless ? SDL_INIT_TIMER | SDL_INIT_EVENTS : SDL_INIT_EVERYTHING;
+        if (SDL_Init(subsystems) < 0 || TTF_Init() < 0) {
                 send_message(MESSAGE_FATAL, "Failed to initialize program: Failed to initialize SDL: %s", SDL_GetMESSAGE_ERROR());
                 terminate(EXIT_FAILURE);
         }
@@ -50,12 +167,12 @@ static void initialize(void) {
                 terminate(EXIT_FAILURE);
         }
 
-        if (!initialize_audio()) {
+        if (!headless && !initialize_audio()) {
                 send_message(MESSAGE_FATAL, "Failed to initialize program: Failed to initialize audio");
                 terminate(EXIT_FAILURE);
         }
 
-        if (!initialize_context()) {
+        if (!(headless ? initialize_headless_context(headless_width, headless_height) : initialize_context(vsync))) {
                 send_message(MESSAGE_FATAL, "Failed to initialize program: Failed to initialize context");
                 terminate(EXIT_FAILURE);
         }
@@ -65,6 +182,9 @@ static void initialize(void) {
                 terminate(EXIT_FAILURE);
         }
 
+        // Glyphs are rasterized again when there's no usable cache, so a failure here isn't fatal
+        load_glyph_cache();
+
         if (!initialize_cursor()) {
                 send_message(MESSAGE_FATAL, "Failed to initialize program: Failed to initialize cursor");
                 terminate(EXIT_FAILURE);
@@ -78,67 +198,207 @@ static void initialize(void) {
         initialize_layers();
         initialize_debug_panel();
 
+        // Frames are measured against the display's refresh rate when vsync paces them, otherwise against the frame rate cap, or
+        // against 60 frames per second when there's neither
+        const int refresh_rate = is_context_vsynced() ? get_context_refresh_rate() : 0;
+        if (refresh_rate > 0) {
+                set_debug_frame_budget(1000.0 / (double)refresh_rate);
+        } else {
+                set_debug_frame_budget(frame_rate ? 1000.0 / (double)frame_rate : 0.0);
+        }
+
+        initialize_job_system();
+
+        // Headless runs build and draw each frame in turn, so that the same run keeps producing the same frames
+        initialize_frame_pipeline(build_frame, !headless);
+
         play_music(MUSIC_BGM);
 
         send_message(MESSAGE_INFORMATION, "Program initialized successfully");
 }
 
 static void update(const double delta_time) {
-        // I need to start profiling when the frame starts because the true FPS gets capped on some environments (like mine)
-        start_debug_frame_profiling();
-
+        // Events stay in the SDL queue when the frame can't take any more of them, and get handed to the next frame instead. No
+        // frame gets built while minimized though, so the queue is drained regardless and whatever arrives in the meantime is dropped,
+        // otherwise a full queue would hide the event that restores the window
         SDL_Event event;
-        while (SDL_PollEvent(&event)) {
+        while ((window_minimized || !is_frame_event_queue_full()) && SDL_PollEvent(&event)) {
                 if (event.type == SDL_QUIT) {
                         terminate(EXIT_SUCCESS);
                 }
 
-                if (event.type == SDL_WINDOW_MINIMIZED) {
-                        SDL_Delay((Uint32)WINDOW_MINIMIZED_THROTTLE);
-                        return;
+                if (event.type == SDL_WINDOWEVENT) {
+                        if (event.window.event == SDL_WINDOWEVENT_MINIMIZED) {
+                                window_minimized = true;
+                        } else if (event.window.event == SDL_WINDOWEVENT_RESTORED || event.window.event == SDL_WINDOWEVENT_MAXIMIZED) {
+                                window_minimized = false;
+                        }
                 }
 
-                if (
-                        scene_manager_receive_event(&event) ||
-                        layers_receive_event(&event)        ||
-                        debug_panel_receive_event(&event)
-                ) {
-                        continue;
+                if (!window_minimized) {
+                        push_frame_event(&event);
                 }
         }
 
-        SDL_Renderer *const renderer = get_context_renderer();
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-        SDL_RenderClear(renderer);
+        // A minimized window shows nothing, so the whole frame is skipped and the game stays paused until it is restored
+        if (window_minimized) {
+                return;
+        }
+
+        bool frame_submitted = false;
+        PROFILE_SCOPE("submit_frame") {
+                frame_submitted = submit_frame(delta_time);
+        }
+
+        if (!frame_submitted) {
+                return;
+        }
+
+        if (frame_dump_directory) {
+                char frame_path[FRAME_PATH_SIZE];
+                snprintf(frame_path, sizeof(frame_path), "%s/frame_%06zu.bmp", frame_dump_directory, frame_index);
+                save_context_frame(frame_path);
+        }
+
+        ++frame_index;
+        PROFILE_SCOPE("present") {
+                SDL_RenderPresent(get_context_renderer());
+        }
+
+        // Measured from present to present, so that hitches in replaying, presenting and pacing show up along with slow builds
+        const Uint64 present_time = SDL_GetPerformanceCounter();
+        if (previous_present_time != 0ULL) {
+                record_debug_frame_interval(1000.0 * (double)(present_time - previous_present_time) / (double)SDL_GetPerformanceFrequency());
+        }
+        previous_present_time = present_time;
+
+        idle = is_frame_pipeline_idle();
+}
+
+// Runs on the simulation thread when there is one, everything drawn in here is recorded into the frame and replayed by update()
+static bool build_frame(const double delta_time) {
+        // I need to start profiling when the frame starts because the true FPS gets capped on some environments (like mine)
+        start_debug_frame_profiling();
+
+        bool received_events = false;
+        PROFILE_SCOPE("build_frame") {
+                PROFILE_SCOPE("dispatch_events") {
+                        SDL_Event event;
+                        while (poll_frame_event(&event)) {
+                                received_events = true;
+                                if (
+                                        scene_manager_receive_event(&event) ||
+                                        layers_receive_event(&event)        ||
+                                        debug_panel_receive_event(&event)
+                                ) {
+                                        continue;
+                                }
+                        }
+                }
 
-        update_layers(delta_time);
-        render_background_layer();
-        update_scene_manager(delta_time);
-        render_transition_layer();
+                record_frame_clear(0, 0, 0, 255);
 
-        update_debug_panel(delta_time);
+                // Only the simulation follows the time scale, the debug panel, the cursor and the animations marked as unscaled
+                // (tooltips and button hovers) keep running in real time
+                const double simulation_delta_time = delta_time * (double)get_context_time_scale();
 
-        update_cursor(delta_time);
-        request_cursor(CURSOR_ARROW);
-        request_tooltip(false);
+                update_glyph_atlases();
 
-        SDL_RenderPresent(renderer);
+                PROFILE_SCOPE("update_animation_system") {
+                        update_animation_system(simulation_delta_time, delta_time);
+                }
 
+                PROFILE_SCOPE("update_layers") {
+                        update_layers(simulation_delta_time);
+                        render_background_layer();
+                }
+
+                PROFILE_SCOPE("update_scene_manager") {
+                        update_scene_manager(simulation_delta_time);
+                        render_transition_layer();
+                }
+
+                PROFILE_SCOPE("update_debug_panel") {
+                        update_debug_panel(delta_time);
+                }
+
+                update_cursor(delta_time);
+                request_cursor(CURSOR_ARROW);
+                request_tooltip(false);
+
+                PROFILE_SCOPE("flush_geometry_batch") {
+                        flush_geometry_batch();
+                        reset_geometry_arena();
+                }
+        }
+
+        mark_profile_frame();
         finish_debug_frame_profiling();
+
+        return !received_events && !is_animation_system_active() && !is_transition_triggered() && !consume_context_redraw() && !is_context_fast_forwarding();
+}
+
+static void pace_frame(void) {
+        // Headless runs go as fast as they can, and a vsynced present already blocks until the display wants the next frame
+        if (headless || frame_rate == 0ULL || is_context_vsynced()) {
+                return;
+        }
+
+        const Uint64 frequency = SDL_GetPerformanceFrequency();
+        const Uint64 frame_ticks = frequency / frame_rate;
+        const Uint64 current_time = SDL_GetPerformanceCounter();
+
+        // Falling more than a whole frame behind (a stall, a drag of the window) drops the debt instead of rushing frames out
+        if (next_frame_deadline == 0ULL || current_time > next_frame_deadline + frame_ticks) {
+                next_frame_deadline = current_time + frame_ticks;
+                return;
+        }
+
+        if (current_time >= next_frame_deadline) {
+                next_frame_deadline += frame_ticks;
+                return;
+        }
+
+        // The scheduler can oversleep by a millisecond or two, so sleeping stops short of the deadline and the rest is spun
+        const Uint64 remaining_milliseconds = (next_frame_deadline - current_time) * 1000ULL / frequency;
+        if (remaining_milliseconds > FRAME_PACER_SPIN_MILLISECONDS) {
+                SDL_Delay((Uint32)(remaining_milliseconds - FRAME_PACER_SPIN_MILLISECONDS));
+        }
+
+        while (SDL_GetPerformanceCounter() < next_frame_deadline) {
+                continue;
+        }
+
+        next_frame_deadline += frame_ticks;
 }
 
 static void terminate(const int exit_code) {
         send_message(MESSAGE_INFORMATION, "Terminating program...");
 
+        terminate_frame_pipeline();
+        terminate_job_system();
+
         terminate_scene_manager();
         terminate_debug_panel();
         terminate_layers();
         terminate_cursor();
+        terminate_animation_system();
+        terminate_geometry_batch();
+        terminate_geometry_arena();
+        terminate_glyph_atlases();
 
         unload_assets();
         terminate_context();
         terminate_audio();
 
+        dump_debug_frame_times();
+
+        if (trace_path) {
+                export_profile_trace(trace_path);
+        }
+
+        terminate_profiler();
+
         TTF_Quit();
         SDL_Quit();
 
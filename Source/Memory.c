@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "SDL.h"
+
 #ifndef NDEBUG
 
 struct AllocationMESSAGE_INFORMATION {
@@ -18,6 +20,11 @@ static struct AllocationMESSAGE_INFORMATION *allocation_MESSAGE_INFORMATIONs = N
 static size_t active_allocations = 0ULL;
 static size_t active_bytes = 0ULL;
 static size_t peak_bytes = 0ULL;
+static size_t allocation_count = 0ULL;
+
+// Tessellation jobs grow their buffers from worker threads, and every thread allocates its own profiler buffer on its first
+// zone, so the allocation list is guarded
+static SDL_SpinLock allocation_lock = 0;
 
 void flush_memory_leaks(void) {
         if (allocation_MESSAGE_INFORMATIONs == NULL) {
@@ -34,6 +41,13 @@ void flush_memory_leaks(void) {
         fflush(stderr);
 }
 
+size_t get_memory_allocation_count(void) {
+        SDL_AtomicLock(&allocation_lock);
+        const size_t count = allocation_count;
+        SDL_AtomicUnlock(&allocation_lock);
+        return count;
+}
+
 static void track_allocation(void *const pointer, const size_t size, const char *const file, const size_t line) {
         struct AllocationMESSAGE_INFORMATION *const allocation_MESSAGE_INFORMATION = malloc(sizeof(struct AllocationMESSAGE_INFORMATION));
         if (allocation_MESSAGE_INFORMATION == NULL) {
@@ -44,10 +58,13 @@ static void track_allocation(void *const pointer, const size_t size, const char
         allocation_MESSAGE_INFORMATION->size = size;
         allocation_MESSAGE_INFORMATION->file = file;
         allocation_MESSAGE_INFORMATION->line = line;
+
+        SDL_AtomicLock(&allocation_lock);
         allocation_MESSAGE_INFORMATION->next = allocation_MESSAGE_INFORMATIONs;
         allocation_MESSAGE_INFORMATIONs = allocation_MESSAGE_INFORMATION;
 
         ++active_allocations;
+        ++allocation_count;
         active_bytes += size;
 
         if (active_bytes > peak_bytes) {
@@ -55,9 +72,12 @@ static void track_allocation(void *const pointer, const size_t size, const char
                 // fprintf(stdout, "MESSAGE_WARNING: Peak memory usage (of %zu bytes) reached with %p (%zu bytes) from %s:%zu\n", peak_bytes, pointer, size, file, line);
                 // fflush(stdout);
         }
+
+        SDL_AtomicUnlock(&allocation_lock);
 }
 
 static void remove_allocation(void *const pointer, const char *const file, const size_t line) {
+        SDL_AtomicLock(&allocation_lock);
         struct AllocationMESSAGE_INFORMATION **current_allocation_MESSAGE_INFORMATION = &allocation_MESSAGE_INFORMATIONs;
 
         while (*current_allocation_MESSAGE_INFORMATION != NULL) {
@@ -68,6 +88,8 @@ static void remove_allocation(void *const pointer, const char *const file, const
                         --active_allocations;
 
                         *current_allocation_MESSAGE_INFORMATION = removed_allocation_MESSAGE_INFORMATION->next;
+                        SDL_AtomicUnlock(&allocation_lock);
+
                         free(removed_allocation_MESSAGE_INFORMATION);
                         return;
                 }
@@ -75,6 +97,7 @@ static void remove_allocation(void *const pointer, const char *const file, const
                 current_allocation_MESSAGE_INFORMATION = &(*current_allocation_MESSAGE_INFORMATION)->next;
         }
 
+        SDL_AtomicUnlock(&allocation_lock);
         fprintf(stderr, "xfree(%p): Unrecognized pointer at %s:%zu\n", pointer, file, line);
         fflush(stderr);
 }
@@ -145,4 +168,8 @@ void _free(void *const pointer, const char *const file, const size_t line) {
         free(pointer);
 }
 
+#elif defined(COUNT_MEMORY_ALLOCATIONS)
+
+size_t memory_allocation_count = 0ULL;
+
 #endif
\ No newline at end of file
@@ -7,6 +7,8 @@
 
 void flush_memory_leaks(void);
 
+size_t get_memory_allocation_count(void);
+
 void *_malloc(const size_t size, const char *const file, const size_t line);
 void *_calloc(const size_t count, const size_t size, const char *const file, const size_t line);
 void *_realloc(void *const pointer, const size_t size, const char *const file, const size_t line);
@@ -21,16 +23,33 @@ void  _free(void *const pointer, const char *const file, const size_t line);
 
 #else
 
+// Release builds only count allocations when asked to, which the benchmarks do, and the count isn't synchronized
+#ifdef COUNT_MEMORY_ALLOCATIONS
+extern size_t memory_allocation_count;
+#define COUNT_MEMORY_ALLOCATION() (++memory_allocation_count)
+#else
+#define COUNT_MEMORY_ALLOCATION() ((void)0)
+#endif
+
 static inline void flush_memory_leaks(void) {
         return;
 }
 
+static inline size_t get_memory_allocation_count(void) {
+#ifdef COUNT_MEMORY_ALLOCATIONS
+        return memory_allocation_count;
+#else
+        return 0ULL;
+#endif
+}
+
 static inline void *xmalloc(const size_t size) {
         void *const allocated = malloc(size);
         if (allocated == NULL) {
                 exit(EXIT_FAILURE);
         }
 
+        COUNT_MEMORY_ALLOCATION();
         return allocated;
 }
 
@@ -40,6 +59,7 @@ static inline void *xcalloc(const size_t count, const size_t size) {
                 exit(EXIT_FAILURE);
         }
 
+        COUNT_MEMORY_ALLOCATION();
         return allocated;
 }
 
@@ -49,6 +69,7 @@ static inline void *xrealloc(void *const pointer, const size_t size) {
                 exit(EXIT_FAILURE);
         }
 
+        COUNT_MEMORY_ALLOCATION();
         return reallocated;
 }
 
@@ -58,6 +79,7 @@ static inline char *xstrdup(const char *const string) {
                 exit(EXIT_FAILURE);
         }
 
+        COUNT_MEMORY_ALLOCATION();
         return duplicated;
 }
 
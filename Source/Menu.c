@@ -104,6 +104,10 @@ static void update_main_menu_scene(const double delta_time) {
         for (size_t level_index = 0ULL; level_index < level_count; ++level_index) {
                 update_button(&buttons[level_index], delta_time);
         }
+
+        for (size_t level_index = 0ULL; level_index < level_count; ++level_index) {
+                render_button(&buttons[level_index]);
+        }
 }
 
 static void terminate_main_menu_scene(void) {
@@ -122,7 +126,7 @@ static void terminate_main_menu_scene(void) {
 static void resize_main_menu_scene(void) {
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
 
         const float grid_padding = fminf((float)drawable_width, (float)drawable_height) / 10.0f;
 
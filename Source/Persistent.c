@@ -21,11 +21,16 @@
 
 #define SAVE_BOOLEAN(json, name) cJSON_AddBoolToObject(json, #name, name)
 
+static char persistent_directory_path[1024];
 static char persistent_data_file_path[1024];
 
 static bool persistent_sound_enabled = true;
 static bool persistent_music_enabled = true;
 
+const char *get_persistent_directory_path(void) {
+        return persistent_directory_path;
+}
+
 bool get_persistent_sound_enabled(void) {
         return persistent_sound_enabled;
 }
@@ -51,6 +56,7 @@ bool load_persistent_data(void) {
                 return false;
         }
 
+        snprintf(persistent_directory_path, sizeof(persistent_directory_path), "%s", writable_directory_path);
         snprintf(persistent_data_file_path, sizeof(persistent_data_file_path), "%s%s", writable_directory_path, "save.json");
         SDL_free(writable_directory_path);
 
@@ -5,6 +5,8 @@
 bool load_persistent_data(void);
 bool save_persistent_data(void);
 
+const char *get_persistent_directory_path(void);
+
 bool get_persistent_sound_enabled(void);
 void set_persistent_sound_enabled(const bool sound_enabled);
 
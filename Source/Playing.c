@@ -247,7 +247,7 @@ static void update_playing_scene(const double delta_time) {
 
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
 
         const float padding = CLAMP_VALUE(fmaxf((float)drawable_width, (float)drawable_height) * 0.02f, 20.0f, 50.0f);
 
@@ -257,7 +257,6 @@ static void update_playing_scene(const double delta_time) {
 
         move_count_label.scale_x = move_count_scale;
         move_count_label.scale_y = move_count_scale;
-        update_animation(&move_count_pulse, delta_time);
 
         size_t move_count_label_height;
         get_text_dimensions(&level_number_label, NULL, &move_count_label_height);
@@ -272,6 +271,13 @@ static void update_playing_scene(const double delta_time) {
         update_button(&quit_button, delta_time);
         update_button(&sounds_button, delta_time);
         update_button(&music_button, delta_time);
+
+        render_button(&undo_button);
+        render_button(&redo_button);
+        render_button(&restart_button);
+        render_button(&quit_button);
+        render_button(&sounds_button);
+        render_button(&music_button);
 }
 
 static void dismiss_playing_scene(void) {
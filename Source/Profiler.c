@@ -0,0 +1,252 @@
+#include "Profiler.h"
+
+#ifndef NDEBUG
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "SDL.h"
+
+#include "Utilities.h"
+
+#define PROFILE_THREAD_LIMIT     16ULL
+#define PROFILE_RING_CAPACITY    16384ULL
+#define PROFILE_SUMMARY_CAPACITY 64ULL
+
+struct ProfileEvent {
+        const char *name;
+        Uint64 start;
+        Uint64 finish;
+};
+
+// Every thread records its zones into its own ring, so zones on different threads never wait on each other. The lock is only
+// contended when the debug panel or the trace export reads a ring back, and the oldest zones get overwritten once a ring is full.
+struct ProfileBuffer {
+        SDL_SpinLock lock;
+        SDL_threadID thread_id;
+        size_t event_count;
+        size_t summarized_event_count;
+        struct ProfileEvent events[PROFILE_RING_CAPACITY];
+};
+
+static struct ProfileBuffer *profile_buffers[PROFILE_THREAD_LIMIT];
+static SDL_atomic_t profile_buffer_count;
+static SDL_atomic_t profile_frame_count;
+
+static _Thread_local struct ProfileBuffer *thread_profile_buffer = NULL;
+static _Thread_local bool thread_profile_buffer_refused = false;
+
+static struct ProfileBuffer *get_thread_profile_buffer(void) {
+        if (thread_profile_buffer || thread_profile_buffer_refused) {
+                return thread_profile_buffer;
+        }
+
+        const size_t buffer_index = (size_t)SDL_AtomicAdd(&profile_buffer_count, 1);
+        if (buffer_index >= PROFILE_THREAD_LIMIT) {
+                send_message(MESSAGE_WARNING, "Failed to profile thread: More than %zu threads are being profiled", PROFILE_THREAD_LIMIT);
+                thread_profile_buffer_refused = true;
+                return NULL;
+        }
+
+        struct ProfileBuffer *const buffer = (struct ProfileBuffer *)xcalloc(1ULL, sizeof(struct ProfileBuffer));
+        buffer->thread_id = SDL_ThreadID();
+        SDL_AtomicSetPtr((void **)&profile_buffers[buffer_index], buffer);
+
+        thread_profile_buffer = buffer;
+        return buffer;
+}
+
+static size_t get_profile_buffer_count(void) {
+        const size_t buffer_count = (size_t)SDL_AtomicGet(&profile_buffer_count);
+        return MINIMUM_VALUE(buffer_count, PROFILE_THREAD_LIMIT);
+}
+
+struct ProfileZone begin_profile_zone(const char *const name) {
+        return (struct ProfileZone){
+                .name = name,
+                .start = SDL_GetPerformanceCounter(),
+                .open = true
+        };
+}
+
+void end_profile_zone(struct ProfileZone *const zone) {
+        const Uint64 finish = SDL_GetPerformanceCounter();
+        zone->open = false;
+
+        struct ProfileBuffer *const buffer = get_thread_profile_buffer();
+        if (!buffer) {
+                return;
+        }
+
+        SDL_AtomicLock(&buffer->lock);
+        buffer->events[buffer->event_count % PROFILE_RING_CAPACITY] = (struct ProfileEvent){
+                .name = zone->name,
+                .start = zone->start,
+                .finish = finish
+        };
+
+        ++buffer->event_count;
+        SDL_AtomicUnlock(&buffer->lock);
+}
+
+void terminate_profiler(void) {
+        // Only called once every other thread is gone, so the rings can't be written to anymore
+        for (size_t buffer_index = 0ULL; buffer_index < get_profile_buffer_count(); ++buffer_index) {
+                xfree(profile_buffers[buffer_index]);
+                profile_buffers[buffer_index] = NULL;
+        }
+
+        SDL_AtomicSet(&profile_buffer_count, 0);
+        thread_profile_buffer = NULL;
+        thread_profile_buffer_refused = false;
+}
+
+void mark_profile_frame(void) {
+        SDL_AtomicAdd(&profile_frame_count, 1);
+}
+
+static inline size_t get_oldest_profile_event(const struct ProfileBuffer *const buffer, const size_t first_event) {
+        const size_t oldest_kept_event = buffer->event_count > PROFILE_RING_CAPACITY ? buffer->event_count - PROFILE_RING_CAPACITY : 0ULL;
+        return MAXIMUM_VALUE(first_event, oldest_kept_event);
+}
+
+size_t summarize_profile_zones(struct ProfileZoneSummary *const out_summaries, const size_t summary_capacity) {
+        const char *zone_names[PROFILE_SUMMARY_CAPACITY];
+        Uint64 zone_ticks[PROFILE_SUMMARY_CAPACITY];
+        size_t zone_calls[PROFILE_SUMMARY_CAPACITY];
+        size_t zone_count = 0ULL;
+
+        // Zones are summed by name across every thread, over the zones that finished since the previous summary
+        for (size_t buffer_index = 0ULL; buffer_index < get_profile_buffer_count(); ++buffer_index) {
+                struct ProfileBuffer *const buffer = (struct ProfileBuffer *)SDL_AtomicGetPtr((void **)&profile_buffers[buffer_index]);
+                if (!buffer) {
+                        continue;
+                }
+
+                SDL_AtomicLock(&buffer->lock);
+                for (size_t event_index = get_oldest_profile_event(buffer, buffer->summarized_event_count); event_index < buffer->event_count; ++event_index) {
+                        const struct ProfileEvent *const event = &buffer->events[event_index % PROFILE_RING_CAPACITY];
+
+                        size_t zone_index = 0ULL;
+                        while (zone_index < zone_count && zone_names[zone_index] != event->name && strcmp(zone_names[zone_index], event->name)) {
+                                ++zone_index;
+                        }
+
+                        if (zone_index == zone_count) {
+                                if (zone_count == PROFILE_SUMMARY_CAPACITY) {
+                                        continue;
+                                }
+
+                                zone_names[zone_index] = event->name;
+                                zone_ticks[zone_index] = 0ULL;
+                                zone_calls[zone_index] = 0ULL;
+                                ++zone_count;
+                        }
+
+                        zone_ticks[zone_index] += event->finish - event->start;
+                        ++zone_calls[zone_index];
+                }
+
+                buffer->summarized_event_count = buffer->event_count;
+                SDL_AtomicUnlock(&buffer->lock);
+        }
+
+        const size_t marked_frame_count = (size_t)SDL_AtomicSet(&profile_frame_count, 0);
+        const size_t frame_count = MAXIMUM_VALUE(marked_frame_count, 1ULL);
+        const double milliseconds_per_tick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+        // Only the few most expensive zones are kept, so a selection of the largest is all the sorting needed
+        size_t summary_count = 0ULL;
+        while (summary_count < summary_capacity && summary_count < zone_count) {
+                size_t largest_index = summary_count;
+                for (size_t zone_index = summary_count + 1ULL; zone_index < zone_count; ++zone_index) {
+                        if (zone_ticks[zone_index] > zone_ticks[largest_index]) {
+                                largest_index = zone_index;
+                        }
+                }
+
+                const char *const name = zone_names[largest_index];
+                const Uint64 ticks = zone_ticks[largest_index];
+                const size_t calls = zone_calls[largest_index];
+                zone_names[largest_index] = zone_names[summary_count];
+                zone_ticks[largest_index] = zone_ticks[summary_count];
+                zone_calls[largest_index] = zone_calls[summary_count];
+
+                out_summaries[summary_count++] = (struct ProfileZoneSummary){
+                        .name = name,
+                        .milliseconds_per_frame = (double)ticks * milliseconds_per_tick / (double)frame_count,
+                        .calls_per_frame = calls / frame_count
+                };
+        }
+
+        return summary_count;
+}
+
+bool export_profile_trace(const char *const path) {
+        FILE *const file = fopen(path, "w");
+        if (!file) {
+                send_message(MESSAGE_ERROR, "Failed to export profile trace: Failed to open \"%s\": %s", path, strerror(errno));
+                return false;
+        }
+
+        const size_t buffer_count = get_profile_buffer_count();
+
+        // Timestamps are written relative to the oldest zone still recorded, which keeps them short and precise
+        Uint64 epoch = UINT64_MAX;
+        for (size_t buffer_index = 0ULL; buffer_index < buffer_count; ++buffer_index) {
+                struct ProfileBuffer *const buffer = (struct ProfileBuffer *)SDL_AtomicGetPtr((void **)&profile_buffers[buffer_index]);
+                if (!buffer) {
+                        continue;
+                }
+
+                SDL_AtomicLock(&buffer->lock);
+                for (size_t event_index = get_oldest_profile_event(buffer, 0ULL); event_index < buffer->event_count; ++event_index) {
+                        epoch = MINIMUM_VALUE(epoch, buffer->events[event_index % PROFILE_RING_CAPACITY].start);
+                }
+
+                SDL_AtomicUnlock(&buffer->lock);
+        }
+
+        // Chrome's trace viewer (and Perfetto) nest the complete events of a thread by their times, which rebuilds the hierarchy
+        const double microseconds_per_tick = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+        bool first_event = true;
+        for (size_t buffer_index = 0ULL; buffer_index < buffer_count; ++buffer_index) {
+                struct ProfileBuffer *const buffer = (struct ProfileBuffer *)SDL_AtomicGetPtr((void **)&profile_buffers[buffer_index]);
+                if (!buffer) {
+                        continue;
+                }
+
+                SDL_AtomicLock(&buffer->lock);
+                fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"Thread %zu\"}}", first_event ? "" : ",", (unsigned long)buffer->thread_id, buffer_index);
+                first_event = false;
+
+                for (size_t event_index = get_oldest_profile_event(buffer, 0ULL); event_index < buffer->event_count; ++event_index) {
+                        const struct ProfileEvent *const event = &buffer->events[event_index % PROFILE_RING_CAPACITY];
+                        fprintf(
+                                file,
+                                ",\n{\"name\":\"%s\",\"cat\":\"zone\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+                                event->name,
+                                (unsigned long)buffer->thread_id,
+                                (double)(event->start - epoch) * microseconds_per_tick,
+                                (double)(event->finish - event->start) * microseconds_per_tick
+                        );
+                }
+
+                SDL_AtomicUnlock(&buffer->lock);
+        }
+
+        fprintf(file, "\n]}\n");
+
+        if (fclose(file)) {
+                send_message(MESSAGE_ERROR, "Failed to export profile trace: Failed to write \"%s\": %s", path, strerror(errno));
+                return false;
+        }
+
+        send_message(MESSAGE_INFORMATION, "Exported profile trace to \"%s\"", path);
+        return true;
+}
+
+#endif
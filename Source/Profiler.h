@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "SDL.h"
+
+#define PROFILE_TOP_ZONE_COUNT 5ULL
+
+struct ProfileZoneSummary {
+        const char *name;
+        double milliseconds_per_frame;
+        size_t calls_per_frame;
+};
+
+#ifdef NDEBUG
+
+#define PROFILE_SCOPE(name)
+
+static inline void terminate_profiler(void) {
+        return;
+}
+
+static inline void mark_profile_frame(void) {
+        return;
+}
+
+static inline size_t summarize_profile_zones(struct ProfileZoneSummary *const out_summaries, const size_t summary_capacity) {
+        return 0ULL;
+}
+
+static inline bool export_profile_trace(const char *const path) {
+        return false;
+}
+
+#else
+
+struct ProfileZone {
+        const char *name;
+        Uint64 start;
+        bool open;
+};
+
+struct ProfileZone begin_profile_zone(const char *const name);
+void end_profile_zone(struct ProfileZone *const zone);
+
+// Every zone variable is named after its line, so that nested zones on separate lines don't shadow each other. A zone only gets
+// recorded when its block runs to the end, leaving it with return, break or goto drops the zone
+#define PROFILE_CONCATENATE_NAMES(first, second) first##second
+#define PROFILE_ZONE_NAME(line) PROFILE_CONCATENATE_NAMES(profile_zone_, line)
+#define PROFILE_SCOPE_AS(name, zone) for (struct ProfileZone zone = begin_profile_zone(name); zone.open; end_profile_zone(&zone))
+#define PROFILE_SCOPE(name) PROFILE_SCOPE_AS(name, PROFILE_ZONE_NAME(__LINE__))
+
+void terminate_profiler(void);
+
+void mark_profile_frame(void);
+
+size_t summarize_profile_zones(struct ProfileZoneSummary *const out_summaries, const size_t summary_capacity);
+
+bool export_profile_trace(const char *const path);
+
+#endif
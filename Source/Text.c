@@ -4,11 +4,20 @@
 #include <stdbool.h>
 
 #include "SDL.h"
-#include "SDL_ttf.h"
 
 #include "Assets.h"
 #include "Context.h"
+#include "Frame.h"
+#include "Geometry.h"
+#include "Glyphs.h"
 #include "Utilities.h"
+#include "Profiler.h"
+
+struct TextLine {
+        size_t first_glyph;
+        size_t glyph_count;
+        float width;
+};
 
 struct TextImplementation {
         char *string;
@@ -16,16 +25,29 @@ struct TextImplementation {
         enum TextAlignment alignment;
         float maximum_width;
         float line_spacing;
-        bool outdated_texture;
-        SDL_Texture *texture;
-        size_t texture_width;
-        size_t texture_height;
+        bool outdated_layout;
+        bool missing_layout;
+        bool laid_out;
+        bool waiting_glyphs;
+        size_t waiting_generation;
+        SDL_Vertex *vertices;
+        SDL_Vertex *transformed_vertices;
+        int *indices;
+        size_t glyph_count;
+        size_t glyph_capacity;
+        struct TextLine *lines;
+        size_t line_count;
+        size_t line_capacity;
+        size_t layout_width;
+        size_t layout_height;
         uint8_t r;
         uint8_t g;
         uint8_t b;
         uint8_t a;
 };
 
+static void outdate_text(struct Text *const text);
+static void refresh_outdated_text(struct Text *const text);
 static void refresh_text(struct Text *const text);
 
 struct Text *create_text(const char *const string, const enum Font font) {
@@ -62,10 +84,21 @@ void initialize_text(struct Text *const text, const char *const string, const en
         text->implementation->alignment = TEXT_ALIGNMENT_LEFT;
         text->implementation->maximum_width = 0.0f;
         text->implementation->line_spacing = 0.0f;
-        text->implementation->outdated_texture = true;
-        text->implementation->texture_width  = (size_t)MISSING_TEXTURE_WIDTH;
-        text->implementation->texture_height = (size_t)MISSING_TEXTURE_HEIGHT;
-        text->implementation->texture = NULL;
+        text->implementation->outdated_layout = true;
+        text->implementation->missing_layout = false;
+        text->implementation->laid_out = false;
+        text->implementation->waiting_glyphs = false;
+        text->implementation->waiting_generation = 0ULL;
+        text->implementation->vertices = NULL;
+        text->implementation->transformed_vertices = NULL;
+        text->implementation->indices = NULL;
+        text->implementation->glyph_count = 0ULL;
+        text->implementation->glyph_capacity = 0ULL;
+        text->implementation->lines = NULL;
+        text->implementation->line_count = 0ULL;
+        text->implementation->line_capacity = 0ULL;
+        text->implementation->layout_width  = (size_t)MISSING_TEXTURE_WIDTH;
+        text->implementation->layout_height = (size_t)MISSING_TEXTURE_HEIGHT;
         text->implementation->r = 255;
         text->implementation->g = 255;
         text->implementation->b = 255;
@@ -83,8 +116,14 @@ void deinitialize_text(struct Text *const text) {
                         xfree(text->implementation->string);
                 }
 
-                if (text->implementation->texture) {
-                        SDL_DestroyTexture(text->implementation->texture);
+                if (text->implementation->vertices) {
+                        xfree(text->implementation->vertices);
+                        xfree(text->implementation->transformed_vertices);
+                        xfree(text->implementation->indices);
+                }
+
+                if (text->implementation->lines) {
+                        xfree(text->implementation->lines);
                 }
 
                 xfree(text->implementation);
@@ -93,10 +132,7 @@ void deinitialize_text(struct Text *const text) {
 }
 
 void update_text(struct Text *const text) {
-        if (text->implementation->outdated_texture) {
-                text->implementation->outdated_texture = false;
-                refresh_text(text);
-        }
+        refresh_outdated_text(text);
 
         if (text->scale_x == 0.0f || text->scale_y == 0.0f) {
                 return;
@@ -104,336 +140,392 @@ void update_text(struct Text *const text) {
 
         int drawable_width;
         int drawable_height;
-        SDL_GetRendererOutputSize(get_context_renderer(), &drawable_width, &drawable_height);
+        get_context_drawable_size(&drawable_width, &drawable_height);
 
         SDL_Rect destination = (SDL_Rect){
-                .x = (int)(text->screen_position_x * (float)drawable_width  + text->relative_offset_x * text->implementation->texture_width  + text->absolute_offset_x),
-                .y = (int)(text->screen_position_y * (float)drawable_height + text->relative_offset_y * text->implementation->texture_height + text->absolute_offset_y),
-                .w = (int)(text->implementation->texture_width  * fabsf(text->scale_x)),
-                .h = (int)(text->implementation->texture_height * fabsf(text->scale_y))
+                .x = (int)(text->screen_position_x * (float)drawable_width  + text->relative_offset_x * text->implementation->layout_width  + text->absolute_offset_x),
+                .y = (int)(text->screen_position_y * (float)drawable_height + text->relative_offset_y * text->implementation->layout_height + text->absolute_offset_y),
+                .w = (int)(text->implementation->layout_width  * fabsf(text->scale_x)),
+                .h = (int)(text->implementation->layout_height * fabsf(text->scale_y))
         };
 
-        SDL_RendererFlip renderer_flip = SDL_FLIP_NONE;
+        // Geometry queued before this text has to land underneath it
+        flush_geometry_batch();
 
-        if (text->scale_x < 0.0f) {
-                renderer_flip &= SDL_FLIP_HORIZONTAL;
+        if (text->implementation->missing_layout) {
+                record_frame_copy(get_mising_texture(), &destination, text->rotation * 180.0f / (float)M_PI);
+                return;
+        }
+
+        if (!text->implementation->glyph_count) {
+                return;
         }
 
-        if (text->scale_y < 0.0f) {
-                renderer_flip &= SDL_FLIP_VERTICAL;
+        int atlas_width;
+        int atlas_height;
+        SDL_Texture *const atlas_texture = get_glyph_atlas_texture(text->implementation->font, &atlas_width, &atlas_height);
+        if (!atlas_texture) {
+                return;
         }
 
-        SDL_Texture *const texture = text->implementation->texture ? text->implementation->texture : get_mising_texture();
+        const float scale_x = fabsf(text->scale_x);
+        const float scale_y = fabsf(text->scale_y);
+        const float width  = (float)text->implementation->layout_width;
+        const float height = (float)text->implementation->layout_height;
+        const float center_x = (float)destination.x + (float)destination.w / 2.0f;
+        const float center_y = (float)destination.y + (float)destination.h / 2.0f;
+        const float sin = sinf(text->rotation);
+        const float cos = cosf(text->rotation);
+
+        const SDL_Color color = (SDL_Color){
+                .r = text->implementation->r,
+                .g = text->implementation->g,
+                .b = text->implementation->b,
+                .a = text->implementation->a
+        };
+
+        // The layout is in unscaled pixels with texture coordinates in atlas pixels, since the atlas can grow after the layout was built
+        const size_t vertex_count = text->implementation->glyph_count * 4ULL;
+        for (size_t vertex_index = 0ULL; vertex_index < vertex_count; ++vertex_index) {
+                const SDL_Vertex *const source = &text->implementation->vertices[vertex_index];
+                SDL_Vertex *const vertex = &text->implementation->transformed_vertices[vertex_index];
+
+                const float local_x = text->scale_x < 0.0f ? width  - source->position.x : source->position.x;
+                const float local_y = text->scale_y < 0.0f ? height - source->position.y : source->position.y;
+                const float dx = (float)destination.x + local_x * scale_x - center_x;
+                const float dy = (float)destination.y + local_y * scale_y - center_y;
+
+                vertex->position.x = center_x + dx * cos - dy * sin;
+                vertex->position.y = center_y + dx * sin + dy * cos;
+                vertex->tex_coord.x = source->tex_coord.x / (float)atlas_width;
+                vertex->tex_coord.y = source->tex_coord.y / (float)atlas_height;
+                vertex->color = color;
+        }
 
-        SDL_SetTextureAlphaMod(texture, (Uint8)text->implementation->a);
-        SDL_RenderCopyEx(get_context_renderer(), texture, NULL, &destination, text->rotation * 180.0f / (float)M_PI, NULL, renderer_flip);
+        record_frame_textured_geometry(
+                atlas_texture,
+                text->implementation->transformed_vertices, vertex_count,
+                text->implementation->indices, text->implementation->glyph_count * 6ULL
+        );
 }
 
 void get_text_dimensions(struct Text *const text, size_t *const width, size_t *const height) {
-        if (text->implementation->outdated_texture) {
-                text->implementation->outdated_texture = false;
-                refresh_text(text);
-        }
+        refresh_outdated_text(text);
 
         if (width != NULL) {
-                *width = text->implementation->texture_width;
+                *width = text->implementation->layout_width;
         }
 
         if (height != NULL) {
-                *height = text->implementation->texture_height;
+                *height = text->implementation->layout_height;
         }
 }
 
 void set_text_string(struct Text *const text, const char *const string) {
         xfree(text->implementation->string);
         text->implementation->string = xstrdup(string);
-        text->implementation->outdated_texture = true;
+        outdate_text(text);
 }
 
 void set_text_font(struct Text *const text, const enum Font font) {
         text->implementation->font = font;
-        text->implementation->outdated_texture = true;
+        outdate_text(text);
 }
 
 void set_text_alignment(struct Text *const text, const enum TextAlignment alignment) {
         text->implementation->alignment = alignment;
-        text->implementation->outdated_texture = true;
+        outdate_text(text);
 }
 
 void set_text_maximum_width(struct Text *const text, const float maximum_width) {
         text->implementation->maximum_width = maximum_width;
-        text->implementation->outdated_texture = true;
+        outdate_text(text);
 }
 
 void set_text_line_spacing(struct Text *const text, const float line_spacing) {
         text->implementation->line_spacing = line_spacing;
-        text->implementation->outdated_texture = true;
+        outdate_text(text);
 }
 
 void set_text_color(struct Text *const text, const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a) {
-        if (text->implementation->r == r && text->implementation->g == g && text->implementation->b == b) {
-                text->implementation->a = a;
-                return;
-        }
-
+        // Glyphs are white in the atlas and get tinted through the vertex colors, so the layout stays valid
         text->implementation->r = r;
         text->implementation->g = g;
         text->implementation->b = b;
         text->implementation->a = a;
+}
 
-        text->implementation->outdated_texture = true;
+void set_text_alpha(struct Text *const text, const uint8_t a) {
+        text->implementation->a = a;
 }
 
-#define MAXIMUM_WORD_SIZE 512ULL
-#define MAXIMUM_LINE_SIZE 1024ULL
-#define MAXIMUM_LINE_COUNT 128ULL
+void get_text_color(const struct Text *const text, uint8_t *const r, uint8_t *const g, uint8_t *const b, uint8_t *const a) {
+        if (r != NULL) {
+                *r = text->implementation->r;
+        }
 
-static void invalidate_text(struct Text *const text) {
-        if (!text->implementation->texture) {
-                return;
+        if (g != NULL) {
+                *g = text->implementation->g;
         }
 
-        if (!apply_missing_texture(text->implementation->texture)) {
-                SDL_DestroyTexture(text->implementation->texture);
-                text->implementation->texture = NULL;
+        if (b != NULL) {
+                *b = text->implementation->b;
+        }
 
-                text->implementation->texture_width  = (size_t)MISSING_TEXTURE_WIDTH;
-                text->implementation->texture_height = (size_t)MISSING_TEXTURE_HEIGHT;
+        if (a != NULL) {
+                *a = text->implementation->a;
         }
 }
 
-static void refresh_text(struct Text *const text) {
-        TTF_Font *const font = get_font(text->implementation->font);
-
-        char word_buffer[MAXIMUM_WORD_SIZE];
-        char line_buffer[MAXIMUM_LINE_SIZE] = "";
-        char *lines[MAXIMUM_LINE_COUNT];
-        size_t line_count = 0ULL;
-        size_t current_width = 0ULL;
-        size_t total_width = 0ULL;
-
-        int space_width;
-        TTF_SizeUTF8(font, " ", &space_width, NULL);
+static void outdate_text(struct Text *const text) {
+        text->implementation->outdated_layout = true;
+        text->implementation->waiting_glyphs = false;
+}
 
-        int line_height;
-        TTF_SizeUTF8(font, "Ay", NULL, &line_height);
+// Queues every glyph of the string that isn't in the atlas yet, and tells whether they are all already there
+static bool request_text_glyphs(struct Text *const text) {
+        const enum Font font = text->implementation->font;
 
-        const size_t line_gap = (size_t)((float)line_height * text->implementation->line_spacing);
-        const size_t maximum_line_width = text->implementation->maximum_width == 0.0f ? SIZE_MAX : (size_t)roundf(text->implementation->maximum_width);
+        struct Glyph glyph;
+        bool ready = request_glyph(font, ' ', &glyph);
 
-        bool previous_space = false;
         const char *position = text->implementation->string;
-        while (*position && line_count < MAXIMUM_LINE_COUNT) {
-                if (*position == ' ' || *position == '\t') {
-                        size_t space_count = 0;
-                        while (*position == ' ' || *position == '\t') {
-                                ++space_count;
-                                ++position;
-                        }
-
-                        if (space_count >= sizeof(word_buffer)) {
-                                send_message(MESSAGE_ERROR, "Failed to refresh space: Too many consecutive spaces");
-                                invalidate_text(text);
-                                return;
-                        }
-
-                        memset(word_buffer, ' ', space_count);
-                        word_buffer[space_count] = '\0';
-
-                        int word_width;
-                        TTF_SizeUTF8(font, word_buffer, &word_width, NULL);
-
-                        strncat(line_buffer, word_buffer, sizeof(line_buffer) - strlen(line_buffer) - 1ULL);
-                        current_width += (size_t)word_width;
-
-                        previous_space = true;
-                        continue;
+        while (*position) {
+                const uint32_t codepoint = decode_utf8_codepoint(&position);
+                if (codepoint != '\n' && codepoint != ' ' && codepoint != '\t' && !request_glyph(font, codepoint, &glyph)) {
+                        ready = false;
                 }
+        }
 
-                const char *word_start = position;
-                while (*position && *position != ' ' && *position != '\t' && *position != '\n') {
-                        ++position;
-                }
+        return ready;
+}
 
-                const size_t word_length = position - word_start;
-                if (word_length >= sizeof(word_buffer)) {
-                        send_message(MESSAGE_ERROR, "Failed to refresh text: Text \"%s\" has word that exceeds the maximum word length of %zu", text->implementation->string, MAXIMUM_WORD_SIZE);
-                        for (size_t line_index = 0ULL; line_index < line_count; ++line_index) {
-                                xfree(lines[line_index]);
-                        }
+// Text that was already laid out keeps showing its previous layout until the worker rasterized the glyphs it is missing,
+// only text that has nothing to show yet rasterizes them right away
+static void refresh_outdated_text(struct Text *const text) {
+        struct TextImplementation *const implementation = text->implementation;
+        if (!implementation->outdated_layout) {
+                return;
+        }
 
-                        invalidate_text(text);
+        if (implementation->laid_out && !implementation->missing_layout) {
+                const size_t generation = get_glyph_atlas_generation(implementation->font);
+                // Frames keep coming while glyphs are on their way, so that the new layout shows up as soon as they land
+                if (implementation->waiting_glyphs && implementation->waiting_generation == generation) {
+                        request_context_redraw();
                         return;
                 }
 
-                strncpy(word_buffer, word_start, word_length);
-                word_buffer[word_length] = '\0';
-
-                int word_width;
-                TTF_SizeUTF8(font, word_buffer, &word_width, NULL);
-
-                const size_t spacing = (line_buffer[0] != '\0') ? (size_t)space_width : 0ULL;
-                const size_t projected_width = current_width + spacing + (size_t)word_width;
-                if (projected_width > maximum_line_width && line_buffer[0] != '\0') {
-                        lines[line_count++] = xstrdup(line_buffer);
-                        if (current_width > total_width) {
-                                total_width = current_width;
-                        }
-
-                        line_buffer[0] = '\0';
-                        current_width = 0ULL;
-                }
-
-                if (line_buffer[0] && !previous_space) {
-                        strncat(line_buffer, " ", sizeof(line_buffer) - strlen(line_buffer) - 1ULL);
-                        current_width += spacing;
+                if (!request_text_glyphs(text)) {
+                        implementation->waiting_glyphs = true;
+                        implementation->waiting_generation = generation;
+                        request_context_redraw();
+                        return;
                 }
+        }
 
-                previous_space = false;
-
-                strncat(line_buffer, word_buffer, sizeof(line_buffer) - strlen(line_buffer) - 1ULL);
-                current_width += (size_t)word_width;
+        implementation->outdated_layout = false;
+        implementation->waiting_glyphs = false;
+        PROFILE_SCOPE("refresh_text") {
+                refresh_text(text);
+        }
+}
 
-                if (*position == '\n' || projected_width > maximum_line_width) {
-                        lines[line_count++] = xstrdup(line_buffer[0] ? line_buffer : " ");
-                        if (current_width > total_width) {
-                                total_width = current_width;
-                        }
+static void invalidate_text(struct Text *const text) {
+        text->implementation->missing_layout = true;
+        text->implementation->glyph_count = 0ULL;
+        text->implementation->layout_width  = (size_t)MISSING_TEXTURE_WIDTH;
+        text->implementation->layout_height = (size_t)MISSING_TEXTURE_HEIGHT;
+}
 
-                        line_buffer[0] = '\0';
-                        current_width = 0ULL;
-                }
+static void reserve_text_glyphs(struct Text *const text, const size_t glyph_count) {
+        struct TextImplementation *const implementation = text->implementation;
+        if (glyph_count <= implementation->glyph_capacity) {
+                return;
+        }
 
-                if (*position == '\n') {
-                        ++position;
-                }
+        const size_t previous_capacity = implementation->glyph_capacity;
+        implementation->glyph_capacity = MAXIMUM_VALUE(glyph_count, previous_capacity * 2ULL);
+        implementation->vertices = (SDL_Vertex *)xrealloc(implementation->vertices, sizeof(SDL_Vertex) * implementation->glyph_capacity * 4ULL);
+        implementation->transformed_vertices = (SDL_Vertex *)xrealloc(implementation->transformed_vertices, sizeof(SDL_Vertex) * implementation->glyph_capacity * 4ULL);
+        implementation->indices = (int *)xrealloc(implementation->indices, sizeof(int) * implementation->glyph_capacity * 6ULL);
+
+        // Every glyph is a quad, so the indices never change once written
+        for (size_t glyph_index = previous_capacity; glyph_index < implementation->glyph_capacity; ++glyph_index) {
+                int *const indices = &implementation->indices[glyph_index * 6ULL];
+                const int first_vertex = (int)(glyph_index * 4ULL);
+                indices[0] = first_vertex;
+                indices[1] = first_vertex + 1;
+                indices[2] = first_vertex + 2;
+                indices[3] = first_vertex + 2;
+                indices[4] = first_vertex + 1;
+                indices[5] = first_vertex + 3;
         }
+}
 
-        if (line_buffer[0] != '\0' && line_count < MAXIMUM_LINE_COUNT) {
-                int line_width;
-                TTF_SizeUTF8(font, line_buffer, &line_width, NULL);
-                lines[line_count++] = xstrdup(line_buffer);
-                if ((size_t)line_width > total_width) {
-                        total_width = (size_t)line_width;
-                }
+static void push_text_line(struct Text *const text, const size_t first_glyph, const size_t end_glyph, const float width) {
+        struct TextImplementation *const implementation = text->implementation;
+        if (implementation->line_count == implementation->line_capacity) {
+                implementation->line_capacity = implementation->line_capacity ? implementation->line_capacity * 2ULL : 8ULL;
+                implementation->lines = (struct TextLine *)xrealloc(implementation->lines, sizeof(struct TextLine) * implementation->line_capacity);
         }
 
-        if (!line_count) {
-                send_message(MESSAGE_ERROR, "Failed to refresh text: Text contains no visible content");
-                invalidate_text(text);
-                return;
+        implementation->lines[implementation->line_count++] = (struct TextLine){
+                .first_glyph = first_glyph,
+                .glyph_count = end_glyph - first_glyph,
+                .width = width
+        };
+}
+
+static void write_text_glyph(struct Text *const text, const struct Glyph *const glyph, const float x, const float y) {
+        const float x1 = x + (float)glyph->offset_x;
+        const float y1 = y;
+        const float x2 = x1 + (float)glyph->width;
+        const float y2 = y1 + (float)glyph->height;
+        const float u1 = (float)glyph->atlas_x;
+        const float v1 = (float)glyph->atlas_y;
+        const float u2 = u1 + (float)glyph->width;
+        const float v2 = v1 + (float)glyph->height;
+
+        SDL_Vertex *const vertices = &text->implementation->vertices[text->implementation->glyph_count * 4ULL];
+        vertices[0] = (SDL_Vertex){ .position = { x1, y1 }, .tex_coord = { u1, v1 } };
+        vertices[1] = (SDL_Vertex){ .position = { x2, y1 }, .tex_coord = { u2, v1 } };
+        vertices[2] = (SDL_Vertex){ .position = { x1, y2 }, .tex_coord = { u1, v2 } };
+        vertices[3] = (SDL_Vertex){ .position = { x2, y2 }, .tex_coord = { u2, v2 } };
+        ++text->implementation->glyph_count;
+}
+
+static void offset_text_glyphs(struct Text *const text, const size_t first_glyph, const size_t end_glyph, const float offset_x, const float offset_y) {
+        for (size_t vertex_index = first_glyph * 4ULL; vertex_index < end_glyph * 4ULL; ++vertex_index) {
+                text->implementation->vertices[vertex_index].position.x += offset_x;
+                text->implementation->vertices[vertex_index].position.y += offset_y;
         }
+}
 
-        const size_t total_height = line_count * line_height + (line_count - 1ULL) * line_gap;
-        SDL_Surface *const surface = SDL_CreateRGBSurfaceWithFormat(0, total_width, total_height, 32, SDL_PIXELFORMAT_RGBA8888);
-        if (!surface) {
-                send_message(MESSAGE_ERROR, "Failed to refresh text: Failed to create surface: %s", SDL_GetMESSAGE_ERROR());
-                for (size_t line_index = 0ULL; line_index < line_count; ++line_index) {
-                        xfree(lines[line_index]);
-                }
+// Lays the string out in a single pass: glyphs are written as quads as soon as they are decoded, and when a word
+// overflows the maximum width only that word's quads are moved down to the next line, so every glyph moves at most once
+static void refresh_text(struct Text *const text) {
+        struct TextImplementation *const implementation = text->implementation;
+        const enum Font font = implementation->font;
 
+        if (!*implementation->string) {
+                send_message(MESSAGE_ERROR, "Failed to refresh text: Text contains no visible content");
                 invalidate_text(text);
                 return;
         }
 
-        if (SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_BLEND) != 0) {
-                send_message(MESSAGE_ERROR, "Failed to refresh text: Failed to set surface blend mode: %s", SDL_GetMESSAGE_ERROR());
+        struct Glyph space_glyph;
+        if (!get_glyph(font, ' ', &space_glyph)) {
+                send_message(MESSAGE_ERROR, "Failed to refresh text: Failed to get the space glyph");
                 invalidate_text(text);
                 return;
         }
 
-        const SDL_Color baked_color = (SDL_Color){
-                .r = text->implementation->r,
-                .g = text->implementation->g,
-                .b = text->implementation->b,
-                .a = 255
-        };
+        const float line_height = (float)get_glyph_line_height(font);
+        const float line_advance = line_height + floorf(line_height * implementation->line_spacing);
+        const float maximum_line_width = implementation->maximum_width == 0.0f ? INFINITY : roundf(implementation->maximum_width);
+
+        // A codepoint is at least one byte, so the byte count bounds the number of quads
+        reserve_text_glyphs(text, strlen(implementation->string));
+        implementation->glyph_count = 0ULL;
+        implementation->line_count = 0ULL;
+
+        float pen_x = 0.0f;
+        float pen_y = 0.0f;
+        float line_width = 0.0f;
+        float total_width = 0.0f;
+        size_t line_first_glyph = 0ULL;
+
+        bool in_word = false;
+        float word_start_x = 0.0f;
+        float width_before_word = 0.0f;
+        size_t word_first_glyph = 0ULL;
+
+        uint32_t previous_codepoint = 0U;
+        const char *position = implementation->string;
+        while (*position) {
+                const uint32_t codepoint = decode_utf8_codepoint(&position);
+
+                if (codepoint == '\n') {
+                        push_text_line(text, line_first_glyph, implementation->glyph_count, line_width);
+                        total_width = fmaxf(total_width, line_width);
+
+                        pen_x = 0.0f;
+                        pen_y += line_advance;
+                        line_width = 0.0f;
+                        line_first_glyph = implementation->glyph_count;
+                        in_word = false;
+                        previous_codepoint = 0U;
+                        continue;
+                }
 
-        for (size_t line_index = 0ULL; line_index < line_count; ++line_index) {
-                SDL_Surface *const line_surface = TTF_RenderUTF8_Blended(font, lines[line_index], baked_color);
-                if (!line_surface) {
-                        send_message(MESSAGE_ERROR, "Failed to refresh text: Failed to render line %zu: %s", line_index, TTF_GetMESSAGE_ERROR());
-                        for (size_t line_index = 0ULL; line_index < line_count; ++line_index) {
-                                xfree(lines[line_index]);
-                        }
+                if (codepoint == ' ' || codepoint == '\t') {
+                        pen_x += (float)space_glyph.advance;
+                        in_word = false;
+                        previous_codepoint = ' ';
+                        continue;
+                }
 
-                        SDL_FreeSurface(surface);
+                struct Glyph glyph;
+                if (!get_glyph(font, codepoint, &glyph)) {
+                        send_message(MESSAGE_ERROR, "Failed to refresh text: Failed to get glyph U+%04X", (unsigned int)codepoint);
                         invalidate_text(text);
                         return;
                 }
 
-                size_t left_side;
-                switch (text->implementation->alignment) {
-                        case TEXT_ALIGNMENT_LEFT: {
-                                left_side = 0ULL;
-                                break;
-                        }
-
-                        case TEXT_ALIGNMENT_CENTER: {
-                                left_side = (total_width - (size_t)line_surface->w) / 2ULL;
-                                break;
-                        }
-
-                        case TEXT_ALIGNMENT_RIGHT: {
-                                left_side = total_width - (size_t)line_surface->w;
-                                break;
-                        }
+                if (previous_codepoint) {
+                        pen_x += (float)get_glyph_kerning(font, previous_codepoint, codepoint);
                 }
 
-                SDL_Rect destination = (SDL_Rect){
-                        .x = (int)left_side,
-                        .y = line_index * (line_height + line_gap),
-                        .w = line_surface->w,
-                        .h = line_surface->h
-                };
-
-                SDL_BlitSurface(line_surface, NULL, surface, &destination);
-                SDL_FreeSurface(line_surface);
-        }
+                if (!in_word) {
+                        in_word = true;
+                        word_start_x = pen_x;
+                        width_before_word = line_width;
+                        word_first_glyph = implementation->glyph_count;
+                }
 
-        for (size_t line_index = 0ULL; line_index < line_count; ++line_index) {
-                xfree(lines[line_index]);
-        }
+                if (glyph.width && glyph.height) {
+                        write_text_glyph(text, &glyph, pen_x, pen_y);
+                }
 
-        SDL_DestroyTexture(text->implementation->texture);
-        if (!(text->implementation->texture = SDL_CreateTexture(get_context_renderer(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, surface->w, surface->h))) {
-                send_message(MESSAGE_ERROR, "Failed to refresh text: Failed to create texture: %s", SDL_GetMESSAGE_ERROR());
-                SDL_FreeSurface(surface);
+                pen_x += (float)glyph.advance;
+                previous_codepoint = codepoint;
 
-                text->implementation->texture_width = MISSING_TEXTURE_WIDTH;
-                text->implementation->texture_height = MISSING_TEXTURE_HEIGHT;
-                return;
-        }
+                // A word that is alone on its line stays there even when it is wider than the line
+                if (pen_x > maximum_line_width && width_before_word > 0.0f) {
+                        push_text_line(text, line_first_glyph, word_first_glyph, width_before_word);
+                        total_width = fmaxf(total_width, width_before_word);
 
-        if (SDL_SetTextureBlendMode(text->implementation->texture, SDL_BLENDMODE_BLEND) != 0) {
-                send_message(MESSAGE_ERROR, "Failed to refresh text: Failed to set texture blend mode: %s", SDL_GetMESSAGE_ERROR());
-                SDL_FreeSurface(surface);
+                        pen_y += line_advance;
+                        offset_text_glyphs(text, word_first_glyph, implementation->glyph_count, -word_start_x, line_advance);
+                        pen_x -= word_start_x;
+                        word_start_x = 0.0f;
+                        width_before_word = 0.0f;
+                        line_first_glyph = word_first_glyph;
+                }
 
-                invalidate_text(text);
-                return;
+                line_width = pen_x;
         }
 
-        void *pixels;
-        int pitch;
-        if (SDL_LockTexture(text->implementation->texture, NULL, &pixels, &pitch) != 0) {
-                send_message(MESSAGE_ERROR, "Failed to refresh text: Failed to lock texture: %s", SDL_GetMESSAGE_ERROR());
-                SDL_FreeSurface(surface);
-
-                invalidate_text(text);
-                return;
+        // A trailing line break doesn't open another line
+        if (position[-1] != '\n') {
+                push_text_line(text, line_first_glyph, implementation->glyph_count, line_width);
+                total_width = fmaxf(total_width, line_width);
         }
 
-        Uint8 *const destination = (Uint8 *)pixels;
-        Uint8 *const source = (Uint8 *)surface->pixels;
-
-        const int copy_pitch = SDL_min(pitch, surface->pitch);
-        for (int row = 0; row < surface->h; ++row) {
-                memcpy(destination + row * pitch, source + row * surface->pitch, copy_pitch);
+        total_width = ceilf(total_width);
+        if (implementation->alignment != TEXT_ALIGNMENT_LEFT) {
+                for (size_t line_index = 0ULL; line_index < implementation->line_count; ++line_index) {
+                        const struct TextLine *const line = &implementation->lines[line_index];
+                        const float free_width = total_width - line->width;
+                        const float offset = implementation->alignment == TEXT_ALIGNMENT_CENTER ? floorf(free_width / 2.0f) : free_width;
+                        offset_text_glyphs(text, line->first_glyph, line->first_glyph + line->glyph_count, offset, 0.0f);
+                }
         }
 
-        text->implementation->texture_width  = surface->w;
-        text->implementation->texture_height = surface->h;
-
-        SDL_UnlockTexture(text->implementation->texture);
-        SDL_FreeSurface(surface);
-}
\ No newline at end of file
+        const size_t line_count = implementation->line_count;
+        implementation->laid_out = true;
+        implementation->missing_layout = false;
+        implementation->layout_width  = (size_t)total_width;
+        implementation->layout_height = (size_t)(line_height * (float)line_count + (line_advance - line_height) * (float)(line_count - 1ULL));
+}
@@ -44,4 +44,6 @@ void set_text_font(struct Text *const text, const enum Font font);
 void set_text_alignment(struct Text *const text, const enum TextAlignment alignment);
 void set_text_maximum_width(struct Text *const text, const float maximum_width);
 void set_text_line_spacing(struct Text *const text, const float line_spacing);
-void set_text_color(struct Text *const text, const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a);
\ No newline at end of file
+void set_text_color(struct Text *const text, const uint8_t r, const uint8_t g, const uint8_t b, const uint8_t a);
+void set_text_alpha(struct Text *const text, const uint8_t a);
+void get_text_color(const struct Text *const text, uint8_t *const r, uint8_t *const g, uint8_t *const b, uint8_t *const a);
\ No newline at end of file
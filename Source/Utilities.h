@@ -79,6 +79,8 @@
 
 #define COLOR_DARK_BROWN    35,  20,   0
 
+#define COLOR_RED          220,  50,  35
+
 #define COLOR_OPAQUE        255
 
 #define COLOR_TRANSPARENT   0
@@ -112,6 +114,48 @@ static inline char *load_text_file(const char *const path) {
         return buffer;
 }
 
+// ================================================================================================
+// Text Helpers
+// ================================================================================================
+
+#define REPLACEMENT_CODEPOINT 0xFFFDU
+
+// Decodes the UTF-8 sequence at the position and moves the position past it, malformed sequences decode to U+FFFD
+static inline uint32_t decode_utf8_codepoint(const char **const position) {
+        const unsigned char *const bytes = (const unsigned char *)*position;
+
+        uint32_t codepoint;
+        size_t length;
+        if (bytes[0] < 0x80U) {
+                codepoint = bytes[0];
+                length = 1ULL;
+        } else if ((bytes[0] & 0xE0U) == 0xC0U) {
+                codepoint = bytes[0] & 0x1FU;
+                length = 2ULL;
+        } else if ((bytes[0] & 0xF0U) == 0xE0U) {
+                codepoint = bytes[0] & 0x0FU;
+                length = 3ULL;
+        } else if ((bytes[0] & 0xF8U) == 0xF0U) {
+                codepoint = bytes[0] & 0x07U;
+                length = 4ULL;
+        } else {
+                *position += 1;
+                return REPLACEMENT_CODEPOINT;
+        }
+
+        for (size_t index = 1ULL; index < length; ++index) {
+                if ((bytes[index] & 0xC0U) != 0x80U) {
+                        *position += index;
+                        return REPLACEMENT_CODEPOINT;
+                }
+
+                codepoint = (codepoint << 6U) | (bytes[index] & 0x3FU);
+        }
+
+        *position += length;
+        return codepoint;
+}
+
 // ================================================================================================
 // Math Helpers
 // ================================================================================================